@@ -0,0 +1,97 @@
+/**
+ * @file box.cpp
+ * @author Antonin Thioux (antonin.thioux@gmail.com)
+ * @brief This file contains a microbenchmark of the native engine's box filter mode against its cascade of binomial passes, for growing kernel sizes.
+ * @date last modified at 2026-10-16
+ * @version 1.0
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "../HullComputation/Parameters.h"
+#include "../HullComputation/Engine.h"
+
+#define BOX_BENCHMARK_SIZE 96 // Width and height of the frames
+#define BOX_BENCHMARK_STEPS 16 // Output time steps per run
+#define BOX_BENCHMARK_DIMENSIONS "box_benchmark.txt"
+
+using namespace HullComputation;
+
+/**
+ * @brief This function renders frames of a bright disc moving across a dark background, so the hulls are a band along its path.
+ * @param frames The number of frames.
+ * @return std::vector<unsigned char> The frames, laid out frame after frame.
+ */
+std::vector<unsigned char> movingDisc(int frames) {
+    std::vector<unsigned char> window((long) frames * BOX_BENCHMARK_SIZE * BOX_BENCHMARK_SIZE);
+    for (int f = 0; f < frames; f++)
+        for (int x = 0; x < BOX_BENCHMARK_SIZE; x++)
+            for (int y = 0; y < BOX_BENCHMARK_SIZE; y++) {
+                float dx = x - 16 - 2 * f, dy = y - BOX_BENCHMARK_SIZE / 2;
+                window[y + BOX_BENCHMARK_SIZE * (x + (long) BOX_BENCHMARK_SIZE * f)] = (dx * dx + dy * dy < 12 * 12) ? 0xFF : 0x10;
+            }
+    return window;
+}
+
+/**
+ * @brief This function computes the labels of a window with the native engine, as the best of a few runs.
+ * @param params The Parameters object.
+ * @param window The frames of the window.
+ * @param labels The labels of the last run.
+ * @return double The time in milliseconds.
+ */
+double measure(Parameters *params, const std::vector<unsigned char> &window, std::vector<float> &labels) {
+    double best = 1e30;
+    for (int run = 0; run < 3; run++) {
+        Engine *engine = Engine::create(params);
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        engine->process(window.data(), params->duration);
+        const float *result = engine->getLabels();
+        std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - begin;
+        best = std::min(best, time.count());
+        labels.assign(result, result + engine->getSize());
+        delete engine;
+    }
+    return best;
+}
+
+/**
+ * This is the main function for the box filter benchmark, it compares both modes on 2D frames with a kernel of size k in every dimension.
+ * The agreement is the share of voxels that are in the hulls of both modes or neither, and the share that get the same label.
+ * @return Exit success when the benchmark is complete.
+ */
+int main() {
+    printf("%4s %14s %12s %8s %10s %10s\n", "k", "binomial (ms)", "boxes (ms)", "speedup", "same hull", "same label");
+    for (int k = 3; k <= 31; k += 2) {
+        int frames = k - 1 + BOX_BENCHMARK_STEPS;
+        FILE *file = fopen(BOX_BENCHMARK_DIMENSIONS, "w");
+        fprintf(file, "%d %d 1\n%d\n", BOX_BENCHMARK_SIZE, BOX_BENCHMARK_SIZE, frames);
+        for (int f = 0; f < frames; f++) fprintf(file, "unused\n");
+        fclose(file);
+
+        std::string size = std::to_string(k);
+        const char *argv[] = {"benchmark_box", BOX_BENCHMARK_DIMENSIONS, "-kx", size.c_str(), "-ky", size.c_str(), "-kt", size.c_str(), "-th", "1", "-e", "native"};
+        Parameters params(sizeof(argv) / sizeof(*argv), (char **) argv);
+        std::vector<unsigned char> window = movingDisc(frames);
+
+        std::vector<float> binomial, boxes;
+        params.isBoxFiltered = 0;
+        double before = measure(&params, window, binomial);
+        params.isBoxFiltered = 1;
+        double after = measure(&params, window, boxes);
+
+        long hull = 0, label = 0;
+        for (size_t i = 0; i < binomial.size(); i++) {
+            hull += ((binomial[i] > 0) == (boxes[i] > 0));
+            label += (binomial[i] == boxes[i]);
+        }
+        printf("%4d %14.2f %12.2f %7.1fx %9.1f%% %9.1f%%\n", k, before, after, before / after, 100.0 * hull / binomial.size(), 100.0 * label / binomial.size());
+    }
+    remove(BOX_BENCHMARK_DIMENSIONS);
+    return 0;
+}
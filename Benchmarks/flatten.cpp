@@ -0,0 +1,99 @@
+/**
+ * @file flatten.cpp
+ * @author Antonin Thioux (antonin.thioux@gmail.com)
+ * @brief This file contains a microbenchmark of the time labelling and flattening of a batch's spacetime cube.
+ * @date last modified at 2026-10-16
+ * @version 1.0
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <arrayfire.h>
+
+// The measure is compared with squared thresholds above 1 in the pipeline, so the labelling cutoff of 1 never decides
+#define FLATTEN_RANGE 4.0f
+#define FLATTEN_THRESHOLD 2.0f
+
+using namespace af;
+
+/**
+ * @brief The labelling as it used to be done: thresholding, then a masked write per time slice before taking the max.
+ * @param spacetime The spacetime cube, with time as the last dimension.
+ * @param threshold The value below which the spacetime cube is ignored.
+ * @param t The label of the first time slice.
+ * @return array The latest label above the threshold per voxel.
+ */
+array sliced(array spacetime, float threshold, int t) {
+    spacetime(spacetime < threshold) = 0;
+    for (int i = 0; i < spacetime.dims(3); i++) {
+        array slice = spacetime(span, span, span, i);
+        slice(slice > 1) = i + t;
+        spacetime(span, span, span, i) = slice;
+    }
+    return max(spacetime, 3);
+}
+
+/**
+ * @brief The labelling as Calc::flattenAndReduce does it, a single expression fused into the max reduction.
+ * @param spacetime The spacetime cube, with time as the last dimension.
+ * @param threshold The value below which the spacetime cube is ignored.
+ * @param t The label of the first time slice.
+ * @return array The latest label above the threshold per voxel.
+ */
+array fused(array spacetime, float threshold, int t) {
+    array steps = range(dim4(1, 1, 1, spacetime.dims(3)), 3) + t;
+    array labels = tile(steps, spacetime.dims(0), spacetime.dims(1), spacetime.dims(2));
+    return max((spacetime >= threshold && spacetime > 1) * labels, 3);
+}
+
+/**
+ * @brief This function times a labelling function, as the best of a few runs, and measures the device memory it allocates.
+ * @param labelling The labelling function.
+ * @param spacetime The spacetime cube.
+ * @param allocated The bytes allocated by the last run, its result included.
+ * @return double The time in milliseconds.
+ */
+double measure(array (*labelling)(array, float, int), const array &spacetime, size_t &allocated) {
+    double best = 1e30;
+    for (int run = 0; run < 5; run++) {
+        array input = spacetime.copy();  // The sliced version writes into its input
+        input.eval();
+        sync();
+        deviceGC();  // Freed buffers would otherwise be reused and not show up as allocations
+        size_t before, after, buffers, lockBytes, lockBuffers;
+        deviceMemInfo(&before, &buffers, &lockBytes, &lockBuffers);
+
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        array result = labelling(input, FLATTEN_THRESHOLD, 1);
+        result.eval();
+        sync();
+        std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - begin;
+        best = std::min(best, time.count());
+
+        deviceMemInfo(&after, &buffers, &lockBytes, &lockBuffers);
+        allocated = after - before;
+    }
+    return best;
+}
+
+/**
+ * This is the main function for the labelling benchmark, it compares both labellings on a 64x64x64 volume of values in [0, FLATTEN_RANGE) for growing batch lengths.
+ * The fused labelling should allocate about its result only, a label cube would show up as 4 bytes per voxel of the batch.
+ * @return Exit success when the benchmark is complete.
+ */
+int main() {
+    printf("%6s %12s %12s %8s %12s %12s\n", "n", "sliced (ms)", "fused (ms)", "speedup", "sliced (MB)", "fused (MB)");
+    for (int n = 8; n <= 512; n *= 2) {
+        array spacetime = randu(64, 64, 64, n) * FLATTEN_RANGE;
+        if (!allTrue<bool>(sliced(spacetime.copy(), FLATTEN_THRESHOLD, 1) == fused(spacetime, FLATTEN_THRESHOLD, 1))) {
+            printf("results differ for n = %d\n", n);
+            return 1;
+        }
+
+        size_t slicedBytes, fusedBytes;
+        double before = measure(sliced, spacetime, slicedBytes), after = measure(fused, spacetime, fusedBytes);
+        printf("%6d %12.2f %12.2f %7.1fx %12.1f %12.1f\n", n, before, after, before / after, slicedBytes / 1048576.0, fusedBytes / 1048576.0);
+    }
+    return 0;
+}
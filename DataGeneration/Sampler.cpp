@@ -16,9 +16,11 @@ using namespace DataGeneration;
  * This is the constructor for the Sampler.
  * @param is3D Boolean whether or not to use 3 dimensions of space or 2.
  * @param isNoisy Whether or not to add noisy to sample.
+ * @param isLegacy Whether or not to save a file per frame instead of a single container.
+ * @param isCompressed Whether or not to compress the frames in the container.
  */
-Sampler::Sampler(int is3D, int isNoisy)
-: height(1), width(1), depth(1), frames(1), noise(0.0f) {
+Sampler::Sampler(int is3D, int isNoisy, int isLegacy, int isCompressed)
+: height(1), width(1), depth(1), frames(1), noise(0.0f), isLegacy(isLegacy), isCompressed(isCompressed) {
     cout << "height: ";
     cin >> height;
 
@@ -50,7 +52,8 @@ Sampler::Sampler(int is3D, int isNoisy)
 }
 
 /**
- * This function samples the shape at given the resolution and saves a binary file for each frame.
+ * This function samples the shape at given the resolution and saves the frames in the container data.stc,
+ * or in legacy mode a binary file for each frame.
  */
 void Sampler::run() {
     random_device randomDevice;
@@ -60,6 +63,9 @@ void Sampler::run() {
     unsigned char data[width][height][depth];
     ofstream file;
     char filename[20];
+    HullComputation::Container *container = nullptr;
+    if (!isLegacy) container = new HullComputation::Container("data.stc", width, height, depth, frames,
+        (isCompressed) ? CONTAINER_ENCODING_DELTA_RLE : CONTAINER_ENCODING_RAW);
 
     for (int f = 0; f < frames; f++) {
         // Collect data for frame f
@@ -85,6 +91,12 @@ void Sampler::run() {
             }
         }
 
+        // Append frame f to the container
+        if (!isLegacy) {
+            container->writeFrame(reinterpret_cast<const unsigned char *>(data));
+            continue;
+        }
+
         // Save the data for frame f in file ./data/{f}.bin
         sprintf(filename, "data/%d.bin", f);
         file.open(filename);
@@ -92,6 +104,12 @@ void Sampler::run() {
         file.close();
     }
 
+    // The container is complete once its index is written
+    if (!isLegacy) {
+        delete container;
+        return;
+    }
+
     // Save dimension.txt file with the specs of the sampled data
     sprintf(filename, "dimensions.txt");
     file.open(filename);
@@ -12,6 +12,7 @@
 #include <random>
 
 #include "Shapes.h"
+#include "../HullComputation/Container.h"
 
 namespace DataGeneration {
     class Sampler {
@@ -21,9 +22,10 @@ namespace DataGeneration {
         int depth;
         int frames;
         double noise;
+        int isLegacy, isCompressed;
         unsigned char (*shapeFunc)(double, double, double, double);
     public:
-        Sampler(int is3D, int isNoisy);
+        Sampler(int is3D, int isNoisy, int isLegacy, int isCompressed);
         void run();
     };
 }
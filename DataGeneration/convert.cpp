@@ -0,0 +1,78 @@
+/**
+ * File: convert.cpp
+ * Author: Antonin Thioux (antonin.thioux@gmail.com)
+ * Updated: 16-10-2026
+ * About: This file contains the convert program that packs a dimensions file and its frame files into a single container.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../HullComputation/Container.h"
+#include "../HullComputation/MappedFile.h"
+
+using namespace std;
+
+/**
+ * This function prints the help display to stdout.
+ */
+void printHelp() {
+    cout << "Usage: convert [-c] <DIMENSION-FILE> <CONTAINER>" << endl;
+    cout << "\t Packs the frames listed in DIMENSION-FILE into the single file CONTAINER" << endl;
+    cout << "\t -c, --compress \t Stores the frames delta and run length encoded" << endl;
+    exit(0);
+}
+
+/**
+ * This function prints an error message and exits.
+ * @param error The error message.
+ */
+void printError(const char *error) {
+    cerr << "Error: " << error << endl;
+    cerr << "\t convert -h \t\t for help" << endl;
+    exit(9);
+}
+
+/**
+ * This is the main function for the convert program.
+ * @param argc The number of arguments.
+ * @param argv The array of arguments.
+ * @return Exit success when the container is written.
+ */
+int main(int argc, char *argv[]) {
+    if (argc == 2 && (string(argv[1]) == "-h" || string(argv[1]) == "--help")) printHelp();
+    int isCompressed = (argc > 1 && (string(argv[1]) == "-c" || string(argv[1]) == "--compress"));
+    if (argc != 3 + isCompressed) printError("expected a dimension file and a container");
+    argv += isCompressed;
+
+    string filepath(argv[1]), line;
+    ifstream file(filepath);
+    if (!file) printError("dimension file not found");
+
+    int width, height, depth, frames;
+    stringstream ss;
+    getline(file, line);
+    ss << line;
+    ss >> width >> height >> depth;
+    ss.clear();
+    getline(file, line);
+    ss << line;
+    ss >> frames;
+    if (!ss) printError("malformed dimension file");
+
+    // Frame paths are relative to the dimension file
+    string path = filepath.substr(0, filepath.rfind('/') + 1);
+    size_t frameSize = (size_t) width * height * depth;
+    int encoding = (isCompressed) ? CONTAINER_ENCODING_DELTA_RLE : CONTAINER_ENCODING_RAW;
+    HullComputation::Container container(argv[2], width, height, depth, frames, encoding);
+    for (int f = 0; f < frames; f++) {
+        if (!getline(file, line)) printError("dimension file lists too few frames");
+        HullComputation::MappedFile frame(path + line, frameSize);
+        container.writeFrame(frame.bytes());
+    }
+
+    return 0;
+}
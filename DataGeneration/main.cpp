@@ -21,6 +21,8 @@ void printHelp() {
     cout << "OPTIONS are:" << endl;
     cout << "\t -2, --2D \t\t generates in 2 dimensions of space instead of 3" << endl;
     cout << "\t -n, --noise \t Adds noise to the Spatio-Temporal Data" << endl;
+    cout << "\t -l, --legacy \t Saves a binary file per frame and a dimensions.txt instead of the data.stc container" << endl;
+    cout << "\t -c, --compress \t Stores the frames in the container delta and run length encoded" << endl;
     exit(0);
 }
 
@@ -41,17 +43,19 @@ void printError(char *flag) {
  * @return Exit success when sampling is complete.
  */
 int main(int argc, char *argv[]) {
-    int is3D = 1, isNoisy = 0;
+    int is3D = 1, isNoisy = 0, isLegacy = 0, isCompressed = 0;
 
     for (int i = 1; i < argc; i++) {
         char *flag = argv[i];
         if (!strcmp(flag, "-h") || !strcmp(flag, "--help")) printHelp();
         else if (!strcmp(flag, "-2") || !strcmp(flag, "--2D")) is3D = 0;
         else if (!strcmp(flag, "-n") || !strcmp(flag, "--noise")) isNoisy = 1;
+        else if (!strcmp(flag, "-l") || !strcmp(flag, "--legacy")) isLegacy = 1;
+        else if (!strcmp(flag, "-c") || !strcmp(flag, "--compress")) isCompressed = 1;
         else printError(flag);
     }
 
-    Sampler sampler(is3D, isNoisy);
+    Sampler sampler(is3D, isNoisy, isLegacy, isCompressed);
     sampler.run();
     return 0;
 }
@@ -1,13 +1,17 @@
 /**
  * @file Calc.cpp
  * @author Antonin Thioux (antonin.thioux@gmail.com)
- * @brief This file contains the logic for computing Spatio-Temporal Hulls.  
+ * @brief This file contains the ArrayFire engine, which computes Spatio-Temporal Hulls on the device.
  * @date last modified at 2022-06-02
  * @version 1.0
  */
 
 #include "Calc.h"
 
+#include <algorithm>
+#include <climits>
+#include <iostream>
+
 using namespace af;
 using namespace HullComputation;
 
@@ -38,142 +42,323 @@ array Calc::guassian(array M, int dim){
 }
 
 /**
- * @brief This function applies a sobel-like operator to a matrix to estimate the partial second derivative.
+ * @brief This function applies a kernel across a single dimension as its differencing passes followed by a cascade of three boxes, in box filter mode.
+ * Every box is the difference of two shifted prefix sums, so the cost does not depend on the kernel size.
+ * The cascade is centred in the kernel and scaled to the sum of the binomial smoothing it stands in for (see Engine::planBoxes).
  * @param M The matrix as arrayfire array.
- * @param dev1 The first partial derivative.
- * @param dev2 The second partial derivative.
- * @return array Resulting matrix as arrayfire array.
+ * @param dim The dimension to use.
+ * @param order The derivative order.
+ * @return array Resulting matrix as arrayfire array, passes[dim] shorter across the dimension.
  */
-array Calc::sobelD2(array M, int dev1, int dev2){
-    const int kernelSizes[4] = {params->kt, (params->is4D) ? params->kz : 1, params->ky, params->kx};
+array Calc::boxFilter(array M, int dim, int order){
+    int widths[3], offset;
+    float gain;
+    planBoxes(passes[dim] - order, widths, offset, gain);
+    for (int o = 0; o < order; o++) M = derivative(M, dim);
+    M = M.as(f32);  // Prefix sums of integer batches could overflow
 
-    for (int dimension = 0; dimension < 4; dimension++){
-        int size = kernelSizes[dimension];
-
-        for (int i = 0; i < size - 1; i++){
-            if (i == 0 && dev1 == dimension) M = derivative(M, dimension);
-            else if (i == 1 && dev2 == dimension) M = derivative(M, dimension);
-            else M = guassian(M, dimension);
-        }
+    for (int w : widths) {
+        if (w == 1) continue;
+        dim4 size = M.dims();
+        int n = size[dim];
+        size[dim] = 1;
+        array sums = join(dim, constant(0, size, f32), accum(M, dim));
+        af::index is[2][4] ={{span, span, span, span}, {span, span, span, span}};
+        is[0][dim] = seq(w, n);
+        is[1][dim] = seq(0, n - w);
+        M = sums(is[0][0], is[0][1], is[0][2], is[0][3]) - sums(is[1][0], is[1][1], is[1][2], is[1][3]);
     }
 
-    return M;
+    af::index is[4] = {span, span, span, span};
+    is[dim] = seq(offset, offset + M.dims(dim) - 2 * offset - 1);
+    return gain * M(is[0], is[1], is[2], is[3]);
 }
 
 /**
- * @brief This function applies a sobel-like operator to a matrix to estimate the partial third derivative.
- * Note: dont call this function with dev1 = dev2 = dev3 in the context of this programs as the defualt kernel sizes are too small!
- * @param M The matrix as arrayfire array.
- * @param dev1 The first partial derivative.
- * @param dev2 The second partial derivative.
- * @param dev3 The third partial derivative.
- * @return array Resulting matrix as arrayfire array.
+ * @brief This function checks whether a dimension is filtered by a cascade of boxes, which box filter mode does for large kernels.
+ * @param dim The dimension to check.
+ * @return true If the dimension is box filtered.
+ */
+bool Calc::isBoxed(int dim){
+    return params->isBoxFiltered && passes[dim] + 1 >= BOX_MIN_SIZE;
+}
+
+/**
+ * @brief This function makes the next filter pass for a group of terms, branching where the terms need different passes.
+ * Within a dimension a term of order o makes its smoothing passes first and its o derivatives last, so terms only branch
+ * once they need to. Once every dimension is filtered, the matrix is the sobel-like operator of the group's terms,
+ * which is squared and added to the spacetime cube.
+ * @param M The partially filtered matrix as arrayfire array.
+ * @param group The terms that share the passes made so far.
+ * @param level The number of dimensions filtered so far.
+ * @param step The number of passes made across the current dimension.
+ * @param spacetime The spacetime cube the terms are added to, empty until the first term.
  */
-array Calc::sobelD3(array M, int dev1, int dev2, int dev3) {
-    const int kernelSizes[4] = {params->kt, (params->is4D) ? params->kz : 1, params->ky, params->kx};
+void Calc::accumulate(array M, const std::vector<Term> &group, int level, int step, array &spacetime){
+    if (level == 4) {
+        float weight = 0;
+        for (const Term &term : group) weight += term.weight;
+        array value = (weight == 1) ? square(M) : weight * square(M);
+        if (spacetime.isempty()) spacetime = value;
+        else spacetime += value;
+        return;
+    }
 
-    for (int dimension = 0; dimension < 4; dimension++){
-        int size = kernelSizes[dimension];
-        int count = (dev1 == dimension) + (dev2 == dimension) + (dev3 == dimension);
+    int dim = dimensions[level];
+    if (step == passes[dim]) {
+        accumulate(M, group, level + 1, 0, spacetime);
+        return;
+    }
 
-        for (int i = 0; i < size - 1; i++){
-            if (count > 0) M = derivative(M, dimension);
-            else M = guassian(M, dimension);
-            count--;
+    // Box filtered dimensions are a single filter per distinct order
+    if (isBoxed(dim)) {
+        for (int order = 0; order <= passes[dim]; order++) {
+            std::vector<Term> matching;
+            for (const Term &term : group)
+                if (term.order[dim] == order) matching.push_back(term);
+            if (matching.empty()) continue;
+            if (matching.size() < group.size()) M.eval();  // Shared by several filters
+            accumulate(boxFilter(M, dim, order), matching, level + 1, 0, spacetime);
         }
+        return;
     }
 
-    return M;
+    std::vector<Term> smoothed, differenced;
+    for (const Term &term : group) {
+        if (step < passes[dim] - term.order[dim]) smoothed.push_back(term);
+        else differenced.push_back(term);
+    }
+
+    if (!smoothed.empty() && !differenced.empty()) M.eval();  // Shared by both branches
+    if (!smoothed.empty()) accumulate(guassian(M, dim), smoothed, level, step + 1, spacetime);
+    if (!differenced.empty()) accumulate(derivative(M, dim), differenced, level, step + 1, spacetime);
+}
+
+/**
+ * @brief This function squares the result of a sobel-like operator, integer results are squared as floats so they can not overflow.
+ * @param M The matrix as arrayfire array.
+ * @return array Resulting matrix as arrayfire array.
+ */
+array Calc::square(array M) {
+    if (precision != f32) M = M.as(f32);
+    return pow2(M);
 }
 
 /**
  * @brief This function flattens the spacetime cube to get the hulls of a batch, then reduces this batch with the previously computed spacetime cube.
+ * Thresholding, time labelling and flattening are a single expression, so they are fused into one pass of the max reduction.
+ * Every threshold of a sweep reduces the same spacetime cube into its own hull.
  * @param spacetime The spacetime cube as arrayfire array.
  */
 void Calc::flattenAndReduce(array spacetime){
-    int n = spacetime.dims(0); 
+    int n = spacetime.dims(3); 
 
-    // perform time labelling
-    for (int i = 0; i < n; i++) {
-        array slice = spacetime(i, span, span, span);
-        slice(slice > 1) = i + t;
-        spacetime(i, span, span, span) = slice;
-    }
-    
-    // perform time flattening
-    array flatten = max(reorder(spacetime, 1, 2, 3, 0), 3);
+    // perform time labelling, range allocates its result so only a label per time step is generated,
+    // it is tiled lazily so the labels of the cube are never written to memory
+    array steps = range(dim4(1, 1, 1, n), 3) + t;
+    array labels = tile(steps, spacetime.dims(0), spacetime.dims(1), spacetime.dims(2));
+
+    for (size_t i = 0; i < thresholds.size(); i++) {
+        array active = spacetime >= thresholds[i] && spacetime > 1;
 
-    // perform reducing
-    hulls = max(hulls, flatten);
+        // perform time flattening, time is the last dimension so no reorder is needed
+        array flatten = max(active * labels, 3);
+
+        // perform reducing
+        if (thresholds.size() == 1) hulls = max(hulls, flatten);
+        else hulls(span, span, span, i) = max(hulls(span, span, span, i), flatten);
+    }
 
     // Update t pointer for labelling
     t += n;
 }
 
 /**
- * @brief Construct a new Calc:: Calc object, creates identiy hulls.
- * @param params The Parameters object.
+ * @brief This function groups the terms by their spatial orders for sliding mode, and computes the temporal stencils.
+ * The temporal stencil of order o is kt - 1 - o smoothing and o differencing passes convolved, tap j weighs the frame j further in time.
  */
-Calc::Calc(Parameters *params):params(params),t(1){
-    // Indentity hull matrix 3D & 4D cases
-    if (params->is4D)
-        hulls = constant(0, params->depth - params->kz + 1, params->height - params->ky + 1, params->width - params->kx + 1, dtype::f32);
-    else   
-        hulls = constant(0, 1, params->height - params->ky + 1, params->width - params->kx + 1, dtype::f32);
+void Calc::planSlides(){
+    for (const Term &term : terms) {
+        size_t i = 0;
+        while (i < slides.size() && !std::equal(term.order, term.order + 3, slides[i].order)) i++;
+        if (i == slides.size()) {
+            Slide slide = {{term.order[0], term.order[1], term.order[2]}, std::vector<float>(params->kt, 0.0f), std::vector<array>(params->kt)};
+            slides.push_back(slide);
+        }
+        slides[i].weights[term.order[3]] += term.weight;
+    }
+
+    taps.resize(params->kt);
+    for (int order = 0; order < params->kt; order++) {
+        std::vector<float> &tap = taps[order];
+        tap.assign(params->kt, 0.0f);
+        tap[0] = 1;
+        for (int p = 0; p < params->kt - 1; p++) {
+            float sign = (p < params->kt - 1 - order) ? 1 : -1;
+            for (int j = p + 1; j > 0; j--) tap[j] += sign * tap[j - 1];
+        }
+    }
 }
 
 /**
- * @brief Processes a batch of data.
- * @param batch The batch of data as arrayfire array.
+ * @brief This function filters a single frame across the spatial dimensions, once per group of terms with the same spatial orders.
+ * Like accumulate the groups form a tree, so passes they share are made once. Each filtered frame is stored in the ring of its group.
+ * @param M The partially filtered frame as arrayfire array.
+ * @param group The indices of the groups that share the passes made so far.
+ * @param dim The dimension being filtered.
+ * @param step The number of passes made across the current dimension.
+ * @param slot The slot of the rings the frame is stored in.
  */
-void Calc::processBatch(array batch){
-    // compute a spacetime cube from the data
-    array spacetime;  
-
-    // If special is 0 or 1 then add Px2 Py2 Pz2* Pt2
-    // *= only in 4D case
-    if (params->special == 0 || params->special == 1) {
-        spacetime = pow2(sobelD2(batch, 0, 0));
-
-        for (int d = 1; d < 4; d++) {
-            if (!params->is4D && d == 1) continue;
-            spacetime += pow2(sobelD2(batch, d, d));
+void Calc::filterFrame(array M, const std::vector<int> &group, int dim, int step, int slot){
+    if (dim == 3) {  // Groups have distinct spatial orders, so a single one is left
+        slides[group[0]].ring[slot] = M.as(f32);
+        slides[group[0]].ring[slot].eval();
+        return;
+    }
+    if (step == passes[dim]) {
+        filterFrame(M, group, dim + 1, 0, slot);
+        return;
+    }
+
+    if (isBoxed(dim)) {
+        for (int order = 0; order <= passes[dim]; order++) {
+            std::vector<int> matching;
+            for (int g : group)
+                if (slides[g].order[dim] == order) matching.push_back(g);
+            if (matching.empty()) continue;
+            if (matching.size() < group.size()) M.eval();  // Shared by several filters
+            filterFrame(boxFilter(M, dim, order), matching, dim + 1, 0, slot);
         }
+        return;
     }
 
-    // If special is 0 then also compute the rest of the D2 matrix (PxPy PxPz* PxPt PyPz* PyPt PzPt*)
-    // *= only in 4D case
-    if (params->special == 0) {
-        for (int d0 = 0; d0 < 4; d0++) {
-            if (!params->is4D && d0 == 1) continue;
-            for (int d1 = d0 + 1; d1 < 4; d1++) {
-                if (!params->is4D && d1 == 1) continue;
-                spacetime += 2 * pow2(sobelD2(batch, d0, d1));
+    std::vector<int> smoothed, differenced;
+    for (int g : group) {
+        if (step < passes[dim] - slides[g].order[dim]) smoothed.push_back(g);
+        else differenced.push_back(g);
+    }
+
+    if (!smoothed.empty() && !differenced.empty()) M.eval();  // Shared by both branches
+    if (!smoothed.empty()) filterFrame(guassian(M, dim), smoothed, dim, step + 1, slot);
+    if (!differenced.empty()) filterFrame(derivative(M, dim), differenced, dim, step + 1, slot);
+}
+
+/**
+ * @brief This function processes a batch a frame at a time, only the spatially filtered frames of the last kt are kept.
+ * Once kt frames are in the rings the temporal stencils combine them into a single time step, which is folded straight into the hulls.
+ * The rings are kept across batches, so every frame is filtered spatially exactly once.
+ * @param batch The frames of the batch that are not in the rings yet, with time as the last dimension.
+ */
+void Calc::processSliding(array batch){
+    std::vector<int> all(slides.size());
+    for (size_t g = 0; g < slides.size(); g++) all[g] = g;
+
+    for (int f = 0; f < batch.dims(3); f++, filtered++) {
+        filterFrame(batch(span, span, span, f).as(precision), all, 0, 0, filtered % params->kt);
+        if (filtered < params->kt - 1) continue;
+
+        // The oldest frame of the stencil is the one after the frame just stored
+        array spacetime;
+        for (Slide &slide : slides)
+            for (int order = 0; order < params->kt; order++) {
+                if (slide.weights[order] == 0) continue;
+                array value;
+                for (int j = 0; j < params->kt; j++) {
+                    float tap = taps[order][j];
+                    if (tap == 0) continue;
+                    array term = tap * slide.ring[(filtered + 1 + j) % params->kt];
+                    if (value.isempty()) value = term;
+                    else value += term;
+                }
+                value = (slide.weights[order] == 1) ? pow2(value) : slide.weights[order] * pow2(value);
+                if (spacetime.isempty()) spacetime = value;
+                else spacetime += value;
             }
+
+        flattenAndReduce(spacetime);
+        hulls.eval();  // Keep the expression of a single time step
+    }
+}
+
+/**
+ * @brief Construct a new Calc:: Calc object, creates identiy hulls.
+ * @param params The Parameters object.
+ */
+Calc::Calc(Parameters *params):Engine(params),precision(f32),filtered(0){
+    // Low precision batches use the smallest signed integer type that holds every filtered value exactly,
+    // 32 bit values are as large as floats so they only keep the values exact
+    if (params->isLowPrecision) {
+        long magnitude = params->worstMagnitude();
+        if (magnitude <= SHRT_MAX) precision = s16;
+        else {
+            if (magnitude <= INT_MAX) precision = s32;
+            std::cerr << "[Calc Warning]: \tThese kernels need more than 16 bit values, low precision saves no memory!" << std::endl;
         }
     }
 
-    // If special is 2 then compute PxPt2 PyPt2 PzPt2*
-    // *= only in 4D case
-    if (params->special == 2) {
-        spacetime = pow2(sobelD3(batch, 0, 0, 3));
-        spacetime += pow2(sobelD3(batch, 0, 0, 2));
-        if (params->is4D) spacetime += pow2(sobelD3(batch, 0, 0, 1));
+    // filter everything that is below threshold^2, low precision batches are not divided by 0xFF so the threshold is scaled up instead
+    // Coarse pyramid levels make fewer passes, so their thresholds are scaled by the gain of the passes
+    for (int threshold : params->thresholds) {
+        float value = threshold * params->gain;
+        value *= value;
+        if (params->isLowPrecision) value *= 0xFF * 0xFF;
+        thresholds.push_back(value);
     }
 
-    // filter everything that is below threshold^2
-    spacetime(spacetime < (params->threshold * params->threshold)) = 0;
+    if (params->isSliding) planSlides();
 
-    // flatten it across time dimension
+    // Indentity hull matrix 3D & 4D cases
+    int sweep = thresholds.size();
+    if (params->is4D)
+        hulls = constant(0, params->depth - params->kz + 1, params->height - params->ky + 1, params->width - params->kx + 1, sweep, dtype::f32);
+    else   
+        hulls = constant(0, 1, params->height - params->ky + 1, params->width - params->kx + 1, sweep, dtype::f32);
+}
+
+/**
+ * @brief Processes a window of frames.
+ * @param frames The frames of the window as u8, laid out frame after frame.
+ * @param length The number of frames in the window.
+ */
+void Calc::process(const unsigned char *frames, int length){
+    // Batches overlap by kt - 1 frames, in sliding mode those are already in the rings so they are not uploaded again
+    long frameSize = (long) params->depth * params->height * params->width;
+    int skip = (params->isSliding && filtered) ? params->kt - 1 : 0;
+
+    // Time is the last dimension of the batch, in low precision mode it is kept as u8, otherwise it is converted to floats in [0, 1]
+    array batch = array(params->depth, params->height, params->width, length - skip, frames + skip * frameSize);
+    if (!params->isLowPrecision) batch = batch.as(f32) / 255.0f;  // A u8 batch divided by 0xFF would be integer division
+
+    if (params->isSliding) {
+        processSliding(batch);
+        return;
+    }
+
+    // compute a spacetime cube from the data, the conversion is lazy so it is fused into the first pass
+    array spacetime;
+    accumulate(batch.as(precision), terms, 0, 0, spacetime);
+
+    // filter everything that is below the thresholds and flatten it across time dimension
     flattenAndReduce(spacetime);
 }
 
 /**
- * @brief Getter for Spatio-Temporal hulls.
- * @return array The hulls as an arrayfire array.
+ * @brief Getter for the hulls before normalisation, each voxel holds the latest time step it was above the threshold.
+ * @return const float* The labels laid out like the frames, the labels of a sweep one after the other.
  */
-array Calc::getHulls(){
-    if (params->is4D)
-        return hulls  / (params->duration - params->kt + 1) * 0xFF;
-    return reorder(hulls, 1, 2, 0)  / (params->duration - params->kt + 1) * 0xFF;
+const float *Calc::getLabels(){
+    labels.resize(hulls.elements());
+    hulls.host(labels.data());
+    return labels.data();
+}
+
+/**
+ * @brief This function continues from the labels and time pointer of a previous run.
+ * @param labels The labels laid out like the frames.
+ * @param t The time pointer.
+ */
+void Calc::resume(const float *labels, int t){
+    hulls = array(hulls.dims(), labels);
+    this->t = t;
+    filtered = 0;  // The border frames of the state come first in the next batch
 }
@@ -10,26 +10,43 @@
 #define BP_CALC_H
 
 #include <arrayfire.h>
+#include <vector>
 
 #include "Parameters.h"
+#include "Engine.h"
 
 namespace HullComputation{
-    class Calc
+    class Calc : public Engine
     {
     private:
-        Parameters *params;
-        af::array hulls;
-        int t;
+        struct Slide {  // Terms of the same spatial orders, they share a ring of the last kt spatially filtered frames
+            int order[3];
+            std::vector<float> weights;  // The summed weight of the terms per temporal order
+            std::vector<af::array> ring;
+        };
+
+        af::array hulls;  // One hull per threshold, along the last dimension
+        std::vector<float> thresholds, labels;
+        af::dtype precision;
         af::array derivative(af::array M, int dim);
         af::array guassian(af::array M, int dim);
-        af::array sobelD2(af::array M, int dev1, int dev2);
-        af::array sobelD3(af::array M, int dev1, int dev2, int dev3);
+        af::array boxFilter(af::array M, int dim, int order);
+        bool isBoxed(int dim);
+        void accumulate(af::array M, const std::vector<Term> &group, int level, int step, af::array &spacetime);
+        af::array square(af::array M);
         void flattenAndReduce(af::array spacetime);
+        std::vector<Slide> slides;
+        std::vector<std::vector<float>> taps;
+        int filtered;
+        void planSlides();
+        void filterFrame(af::array M, const std::vector<int> &group, int dim, int step, int slot);
+        void processSliding(af::array batch);
 
     public:
         Calc(Parameters *params);
-        void processBatch(af::array batch);
-        af::array getHulls();
+        void process(const unsigned char *frames, int length);
+        const float *getLabels();
+        void resume(const float *labels, int t);
     };
 }
 
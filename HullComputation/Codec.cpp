@@ -0,0 +1,127 @@
+/**
+ * @file Codec.cpp
+ * @author Antonin Thioux (antonin.thioux@gmail.com)
+ * @brief This file contains the frame codec, frames are stored as their difference with the previous frame and run length encoded.
+ * A control byte c < 0x80 is followed by c + 1 literal bytes. A control byte c >= 0x80 is followed by a byte that is
+ * repeated (c & 0x7F) + 3 times, when (c & 0x7F) is 0x7F a varint with the remaining length follows.
+ * @date last modified at 2026-10-16
+ * @version 1.0
+ */
+
+#include "Codec.h"
+
+#include <iostream>
+#include <cstring>
+
+#define MIN_RUN 3
+#define MAX_LITERAL 128
+#define LONG_RUN (0x7F + MIN_RUN)
+
+using namespace HullComputation;
+
+/**
+ * @brief This function gives the largest payload a frame can be encoded to.
+ * @param n The number of bytes in a frame.
+ * @return size_t The maximum number of bytes of a payload.
+ */
+size_t Codec::bound(size_t n){
+    return n + n / MAX_LITERAL + 1;
+}
+
+/**
+ * @brief This function encodes a frame against the previous frame.
+ * @param frame The frame to encode.
+ * @param previous The previous frame or nullptr for a key frame.
+ * @param n The number of bytes in a frame.
+ * @param payload Where to write the encoded frame, should fit bound(n) bytes.
+ * @return size_t The number of bytes of the payload.
+ */
+size_t Codec::encode(const unsigned char *frame, const unsigned char *previous, size_t n, unsigned char *payload){
+    size_t size = 0, literal = 0, i = 0;
+    auto residual = [&](size_t j) -> unsigned char { return (previous) ? frame[j] - previous[j] : frame[j]; };
+
+    while (i < n) {
+        unsigned char value = residual(i);
+        size_t run = 1;
+        while (i + run < n && residual(i + run) == value) run++;
+
+        if (run < MIN_RUN) {  // Extend the pending literal run
+            for (size_t j = 0; j < run; j++) {
+                if (literal == 0) payload[size++] = 0;
+                payload[size++] = residual(i + j);
+                payload[size - literal - 2] = literal;
+                literal = (literal + 1) % MAX_LITERAL;
+            }
+        } else {
+            literal = 0;
+            if (run < LONG_RUN) {
+                payload[size++] = 0x80 | (run - MIN_RUN);
+                payload[size++] = value;
+            } else {
+                payload[size++] = 0xFF;
+                payload[size++] = value;
+                for (size_t rest = run - LONG_RUN; ; rest >>= 7) {
+                    payload[size++] = (rest & 0x7F) | ((rest > 0x7F) ? 0x80 : 0);
+                    if (rest <= 0x7F) break;
+                }
+            }
+        }
+        i += run;
+    }
+
+    return size;
+}
+
+/**
+ * @brief This function decodes a payload into the residual of a frame, frames can be decoded independently of each other.
+ * @param payload The encoded frame.
+ * @param size The number of bytes in the payload.
+ * @param residual Where to write the residual.
+ * @param n The number of bytes in a frame.
+ */
+void Codec::decode(const unsigned char *payload, size_t size, unsigned char *residual, size_t n){
+    size_t p = 0, i = 0;
+    while (p < size && i < n) {
+        unsigned char control = payload[p++];
+        if (control < 0x80) {
+            size_t length = control + 1;
+            if (i + length > n || p + length > size) break;
+            memcpy(residual + i, payload + p, length);
+            p += length;
+            i += length;
+        } else {
+            size_t length = (control & 0x7F) + MIN_RUN;
+            if (p >= size) break;  // Truncated before the value of the run
+            unsigned char value = payload[p++];
+            if ((control & 0x7F) == 0x7F) {
+                bool more = true;
+                for (int shift = 0; more; shift += 7) {
+                    if (p >= size || shift >= 32) break;  // Truncated, or too long for the length of a run
+                    unsigned char byte = payload[p++];
+                    length += (size_t) (byte & 0x7F) << shift;
+                    more = byte & 0x80;
+                }
+                if (more) break;
+            }
+            if (i + length > n) break;
+            memset(residual + i, value, length);
+            i += length;
+        }
+    }
+
+    if (i != n) {
+        std::cerr << "[Codec Error]: \tCorrupt frame payload!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * @brief This function turns a decoded residual into a frame by adding the previous frame.
+ * @param previous The previous frame.
+ * @param frame The residual, which is overwritten with the frame.
+ * @param n The number of bytes in a frame.
+ */
+void Codec::apply(const unsigned char *previous, unsigned char *frame, size_t n){
+    for (size_t i = 0; i < n; i++)
+        frame[i] += previous[i];
+}
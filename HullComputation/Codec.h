@@ -0,0 +1,24 @@
+/**
+ * @file Codec.h
+ * @author Antonin Thioux (antonin.thioux@gmail.com)
+ * @brief Header file of Codec.cpp
+ * @date last modified at 2026-10-16
+ * @version 1.0
+ */
+
+#ifndef BP_CODEC_H
+#define BP_CODEC_H
+
+#include <cstddef>
+
+namespace HullComputation {
+    class Codec {
+    public:
+        static size_t bound(size_t n);
+        static size_t encode(const unsigned char *frame, const unsigned char *previous, size_t n, unsigned char *payload);
+        static void decode(const unsigned char *payload, size_t size, unsigned char *residual, size_t n);
+        static void apply(const unsigned char *previous, unsigned char *frame, size_t n);
+    };
+}
+
+#endif
@@ -0,0 +1,312 @@
+/**
+ * @file Container.cpp
+ * @author Antonin Thioux (antonin.thioux@gmail.com)
+ * @brief This file contains the logic for the single file container of Spatio-Temporal data.
+ * A container is a header, a frame index and the frame payloads, each raw payload is aligned to a page.
+ * Encoded payloads are packed back to back, every keyInterval frames a key frame is encoded without its predecessor.
+ * @date last modified at 2026-10-16
+ * @version 1.0
+ */
+
+#include "Container.h"
+#include "Codec.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace HullComputation;
+using namespace std;
+
+/**
+ * @brief This helper function rounds an offset up to the container alignment.
+ * @param offset The offset to align.
+ * @return uint64_t The aligned offset.
+ */
+static uint64_t align(uint64_t offset){
+    return (offset + CONTAINER_ALIGNMENT - 1) / CONTAINER_ALIGNMENT * CONTAINER_ALIGNMENT;
+}
+
+/**
+ * @brief This function displays a container error and exits.
+ * @param error The error message to display.
+ */
+void Container::printError(const char *error){
+    cerr << "[Container Error]: \t" << error << endl;
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief This helper function reads a range of the container, retrying on short reads.
+ * @param destination Where to read to.
+ * @param size The number of bytes to read.
+ * @param offset The offset in the container.
+ */
+void Container::readAt(void *destination, uint64_t size, uint64_t offset){
+    char *bytes = (char *) destination;
+    while (size > 0) {
+        ssize_t n = pread(fd, bytes, size, offset);
+        if (n <= 0) printError("Unexpected end of container!");
+        bytes += n;
+        size -= n;
+        offset += n;
+    }
+}
+
+/**
+ * @brief This helper function writes a range of the container, retrying on short writes.
+ * @param source What to write.
+ * @param size The number of bytes to write.
+ * @param offset The offset in the container.
+ */
+void Container::writeAt(const void *source, uint64_t size, uint64_t offset){
+    const char *bytes = (const char *) source;
+    while (size > 0) {
+        ssize_t n = pwrite(fd, bytes, size, offset);
+        if (n <= 0) printError("Could not write to container!");
+        bytes += n;
+        size -= n;
+        offset += n;
+    }
+}
+
+/**
+ * @brief This function checks whether a file is a container by its magic number.
+ * @param filename The path to the file.
+ * @return true If the file is a container.
+ */
+bool Container::isContainer(string filename){
+    char magic[8] = {0};
+    ifstream file(filename, ios::binary);
+    file.read(magic, sizeof(magic));
+    return file && !memcmp(magic, CONTAINER_MAGIC, sizeof(magic));
+}
+
+/**
+ * @brief Construct a new Container object, opens an existing container for reading.
+ * @param filename The path to the container.
+ */
+Container::Container(string filename):isWriting(0),written(0),end(0),previous(nullptr),payload(nullptr){
+    fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) printError("Container not found!");
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    readAt(&header, sizeof(header), 0);
+    if (memcmp(header.magic, CONTAINER_MAGIC, sizeof(header.magic))) printError("Not a container!");
+    if (header.dtype != CONTAINER_DTYPE_U8) printError("Unsupported container data type!");
+    if (header.encoding != CONTAINER_ENCODING_RAW && header.encoding != CONTAINER_ENCODING_DELTA_RLE)
+        printError("Unsupported container encoding!");
+
+    // Nothing on disk is trusted, a corrupt index would otherwise overflow the buffers frames are read into
+    struct stat info;
+    if (fstat(fd, &info) < 0) printError("Could not read container!");
+    uint64_t fileSize = info.st_size;
+    if (!header.width || !header.height || !header.depth || !header.frames) printError("Container has empty dimensions!");
+    if (header.encoding == CONTAINER_ENCODING_DELTA_RLE && !header.keyInterval) printError("Container has no key frames!");
+    if (header.indexOffset < sizeof(header) || header.indexOffset > fileSize
+        || (fileSize - header.indexOffset) / sizeof(ContainerEntry) < header.frames) printError("Container index is truncated!");
+
+    index = new ContainerEntry[header.frames];
+    readAt(index, sizeof(ContainerEntry) * header.frames, header.indexOffset);
+
+    uint64_t n = (uint64_t) header.width * header.height * header.depth;
+    uint64_t limit = (header.encoding == CONTAINER_ENCODING_RAW) ? n : Codec::bound(n);
+    for (uint32_t f = 0; f < header.frames; f++) {
+        if (index[f].offset > fileSize || index[f].size > fileSize - index[f].offset) printError("Container frame is truncated!");
+        if ((header.encoding == CONTAINER_ENCODING_RAW) ? index[f].size != n : index[f].size > limit) printError("Container frame has an invalid size!");
+    }
+}
+
+/**
+ * @brief Construct a new Container object, creates a container to write frames to.
+ * @param filename The path to the container.
+ * @param width The width of the frames.
+ * @param height The height of the frames.
+ * @param depth The depth of the frames.
+ * @param frames The number of frames that will be written.
+ * @param encoding The encoding of the payloads.
+ */
+Container::Container(string filename, int width, int height, int depth, int frames, int encoding)
+:isWriting(1),written(0),previous(nullptr),payload(nullptr){
+    fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) printError("Could not create container!");
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CONTAINER_MAGIC, sizeof(header.magic));
+    header.width = width;
+    header.height = height;
+    header.depth = depth;
+    header.frames = frames;
+    header.dtype = CONTAINER_DTYPE_U8;
+    header.encoding = encoding;
+    header.indexOffset = sizeof(header);
+    header.keyInterval = CONTAINER_KEY_INTERVAL;
+
+    if (encoding == CONTAINER_ENCODING_DELTA_RLE) {
+        size_t n = (size_t) width * height * depth;
+        previous = new unsigned char[n];
+        payload = new unsigned char[Codec::bound(n)];
+    }
+
+    index = new ContainerEntry[frames];
+    memset(index, 0, sizeof(ContainerEntry) * frames);
+    end = align(header.indexOffset + sizeof(ContainerEntry) * frames);
+}
+
+/**
+ * @brief Destroy the Container object, a container being written gets its header and index written last.
+ */
+Container::~Container(){
+    if (isWriting) {
+        if (written != (int) header.frames) cerr << "[Container Warning]: \tonly " << written << " frames were written!" << endl;
+        writeAt(&header, sizeof(header), 0);
+        writeAt(index, sizeof(ContainerEntry) * header.frames, header.indexOffset);
+        if (ftruncate(fd, end) < 0) printError("Could not write to container!");
+    }
+    close(fd);
+    delete [] index;
+    delete [] previous;
+    delete [] payload;
+}
+
+/**
+ * @brief Getter for the width of the frames.
+ * @return int The width.
+ */
+int Container::getWidth(){
+    return header.width;
+}
+
+/**
+ * @brief Getter for the height of the frames.
+ * @return int The height.
+ */
+int Container::getHeight(){
+    return header.height;
+}
+
+/**
+ * @brief Getter for the depth of the frames.
+ * @return int The depth.
+ */
+int Container::getDepth(){
+    return header.depth;
+}
+
+/**
+ * @brief Getter for the number of frames in the container.
+ * @return int The number of frames.
+ */
+int Container::getFrames(){
+    return header.frames;
+}
+
+/**
+ * @brief Getter for the encoding of the payloads.
+ * @return int The encoding.
+ */
+int Container::getEncoding(){
+    return header.encoding;
+}
+
+/**
+ * @brief This function checks whether a frame can be decoded without its predecessor.
+ * @param frame The index of the frame.
+ * @return int True if the frame is a key frame.
+ */
+int Container::isKeyFrame(int frame){
+    return header.encoding == CONTAINER_ENCODING_RAW || frame % header.keyInterval == 0;
+}
+
+/**
+ * @brief This function gives the key frame a frame is decoded from.
+ * @param frame The index of the frame.
+ * @return int The index of the closest key frame at or before the frame.
+ */
+int Container::getKeyFrame(int frame){
+    if (header.encoding == CONTAINER_ENCODING_RAW) return frame;
+    return frame - frame % header.keyInterval;
+}
+
+/**
+ * @brief Getter for the size of the payload of a frame.
+ * @param frame The index of the frame.
+ * @return uint64_t The number of bytes in the payload.
+ */
+uint64_t Container::getPayloadSize(int frame){
+    return index[frame].size;
+}
+
+/**
+ * @brief This function reads the payload of a frame as stored, it is safe to call from multiple threads.
+ * @param frame The index of the frame.
+ * @param destination Where to read the payload to, should fit getPayloadSize bytes.
+ * @return true If the payload was read, false if the container has no such frame.
+ */
+bool Container::readPayload(int frame, unsigned char *destination){
+    if (frame < 0 || frame >= (int) header.frames) return false;
+    readAt(destination, index[frame].size, index[frame].offset);
+    return true;
+}
+
+/**
+ * @brief This function reads a frame into the destination, raw frames are read straight into it.
+ * Encoded frames are decoded from their key frame onwards, so prefer decoding windows of frames in order.
+ * @param frame The index of the frame.
+ * @param destination Where to read the frame to, should fit width * height * depth bytes.
+ * @return true If the frame was read, false if the container has no such frame.
+ */
+bool Container::readFrame(int frame, unsigned char *destination){
+    if (header.encoding == CONTAINER_ENCODING_RAW) return readPayload(frame, destination);
+    if (frame < 0 || frame >= (int) header.frames) return false;
+
+    size_t n = (size_t) header.width * header.height * header.depth;
+    unsigned char *residual = new unsigned char[n], *encoded = nullptr;
+    for (int f = getKeyFrame(frame); f <= frame; f++) {
+        encoded = new unsigned char[index[f].size];
+        readPayload(f, encoded);
+        Codec::decode(encoded, index[f].size, (isKeyFrame(f)) ? destination : residual, n);
+        if (!isKeyFrame(f)) Codec::apply(residual, destination, n);
+        delete [] encoded;
+    }
+    delete [] residual;
+    return true;
+}
+
+/**
+ * @brief This function reads a byte range of a raw frame, it is safe to call from multiple threads.
+ * @param frame The index of the frame.
+ * @param start The offset of the range within the frame.
+ * @param size The number of bytes in the range.
+ * @param destination Where to read the range to.
+ * @return true If the range was read, false if the container has no such frame or range.
+ */
+bool Container::readFrameRange(int frame, uint64_t start, uint64_t size, unsigned char *destination){
+    if (header.encoding != CONTAINER_ENCODING_RAW) printError("Ranges can only be read from raw containers!");
+    if (frame < 0 || frame >= (int) header.frames || start + size > index[frame].size) return false;
+    readAt(destination, size, index[frame].offset + start);
+    return true;
+}
+
+/**
+ * @brief This function appends the next frame to a container being written.
+ * @param data The frame of width * height * depth bytes.
+ */
+void Container::writeFrame(const unsigned char *data){
+    if (!isWriting || written >= (int) header.frames) printError("Too many frames written to container!");
+
+    uint64_t size = (uint64_t) header.width * header.height * header.depth;
+    if (header.encoding == CONTAINER_ENCODING_DELTA_RLE) {
+        size_t n = size;
+        size = Codec::encode(data, (isKeyFrame(written)) ? nullptr : previous, n, payload);
+        memcpy(previous, data, n);
+    }
+
+    index[written].offset = end;
+    index[written].size = size;
+    writeAt((header.encoding == CONTAINER_ENCODING_RAW) ? data : payload, size, end);
+
+    end = (header.encoding == CONTAINER_ENCODING_RAW) ? align(end + size) : end + size;
+    written++;
+}
@@ -0,0 +1,77 @@
+/**
+ * @file Container.h
+ * @author Antonin Thioux (antonin.thioux@gmail.com)
+ * @brief Header file of Container.cpp
+ * @date last modified at 2026-10-16
+ * @version 1.0
+ */
+
+#ifndef BP_CONTAINER_H
+#define BP_CONTAINER_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdint>
+
+#define CONTAINER_MAGIC "STHULL01"
+#define CONTAINER_ALIGNMENT 4096
+#define CONTAINER_DTYPE_U8 0
+#define CONTAINER_ENCODING_RAW 0
+#define CONTAINER_ENCODING_DELTA_RLE 1
+#define CONTAINER_KEY_INTERVAL 16
+
+namespace HullComputation {
+    /**
+     * @brief The header at the start of a container, it is followed by the frame index.
+     */
+    struct ContainerHeader {
+        char magic[8];
+        uint32_t width, height, depth, frames;
+        uint32_t dtype, encoding;
+        uint64_t indexOffset;
+        uint32_t keyInterval, padding;
+        uint64_t reserved[2];
+    };
+
+    /**
+     * @brief An entry in the frame index, raw payloads always start on an aligned offset.
+     */
+    struct ContainerEntry {
+        uint64_t offset, size;
+    };
+
+    class Container {
+    private:
+        int fd, isWriting, written;
+        uint64_t end;
+        ContainerHeader header;
+        ContainerEntry *index;
+        unsigned char *previous, *payload;
+        void readAt(void *destination, uint64_t size, uint64_t offset);
+        void writeAt(const void *source, uint64_t size, uint64_t offset);
+        void printError(const char *error);
+
+    public:
+        static bool isContainer(std::string filename);
+        Container(std::string filename);
+        Container(std::string filename, int width, int height, int depth, int frames, int encoding = CONTAINER_ENCODING_RAW);
+        ~Container();
+        Container(const Container &) = delete;
+        Container &operator=(const Container &) = delete;
+        int getWidth();
+        int getHeight();
+        int getDepth();
+        int getFrames();
+        int getEncoding();
+        int isKeyFrame(int frame);
+        int getKeyFrame(int frame);
+        uint64_t getPayloadSize(int frame);
+        bool readPayload(int frame, unsigned char *destination);
+        bool readFrame(int frame, unsigned char *destination);
+        bool readFrameRange(int frame, uint64_t start, uint64_t size, unsigned char *destination);
+        void writeFrame(const unsigned char *data);
+    };
+}
+
+#endif
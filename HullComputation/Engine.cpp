@@ -0,0 +1,193 @@
+/**
+ * @file Engine.cpp
+ * @author Antonin Thioux (antonin.thioux@gmail.com)
+ * @brief This file contains the interface the compute engines share, frames go in and hulls come out as host buffers.
+ * @date last modified at 2026-10-16
+ * @version 1.0
+ */
+
+#include "Engine.h"
+#include "Native.h"
+#ifdef BP_ARRAYFIRE
+#include "Calc.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+
+using namespace HullComputation;
+
+/**
+ * @brief This function adds a term of sobel-like operator to the spacetime sum, dimension -1 is not differentiated.
+ * Note: dont add a term with dev1 = dev2 = dev3 in the context of this programs as the defualt kernel sizes are too small!
+ * @param dev1 The first partial derivative.
+ * @param dev2 The second partial derivative.
+ * @param dev3 The third partial derivative.
+ * @param weight The factor the squared term is multiplied by.
+ */
+void Engine::addTerm(int dev1, int dev2, int dev3, float weight){
+    Term term = {{0, 0, 0, 0}, weight};
+    for (int dev : {dev1, dev2, dev3})
+        if (dev != -1) term.order[dev]++;
+    terms.push_back(term);
+}
+
+/**
+ * @brief This function lists the terms of the chosen special mode and the order the dimensions are filtered in.
+ * Smoothing and differencing passes commute, so the terms form a tree in which each distinct prefix of passes is computed once.
+ * Dimensions with the fewest distinct orders are filtered first, so that the tree branches as late as possible.
+ */
+void Engine::planTerms(){
+    // Dimensions of the batch are (z, y, x, t)
+    // If special is 0 or 1 then add Px2 Py2 Pz2* Pt2
+    // *= only in 4D case
+    if (params->special == 0 || params->special == 1) {
+        addTerm(3, 3, -1, 1);
+        for (int d = 0; d < 3; d++) {
+            if (!params->is4D && d == 0) continue;
+            addTerm(d, d, -1, 1);
+        }
+    }
+
+    // If special is 0 then also compute the rest of the D2 matrix (PxPy PxPz* PxPt PyPz* PyPt PzPt*)
+    // *= only in 4D case
+    if (params->special == 0) {
+        for (int d0 = 0; d0 < 4; d0++) {
+            if (!params->is4D && d0 == 0) continue;
+            for (int d1 = d0 + 1; d1 < 4; d1++)
+                addTerm(d0, d1, -1, 2);
+        }
+    }
+
+    // If special is 2 then compute PxPt2 PyPt2 PzPt2*
+    // *= only in 4D case
+    if (params->special == 2) {
+        addTerm(3, 3, 2, 1);
+        addTerm(3, 3, 1, 1);
+        if (params->is4D) addTerm(3, 3, 0, 1);
+    }
+
+    int distinct[4];
+    for (int d = 0; d < 4; d++) {
+        int seen[4] = {0, 0, 0, 0};
+        for (const Term &term : terms) seen[term.order[d]] = 1;
+        distinct[d] = seen[0] + seen[1] + seen[2] + seen[3];
+        dimensions[d] = d;
+    }
+    std::stable_sort(dimensions, dimensions + 4, [&](int a, int b) { return distinct[a] < distinct[b]; });
+}
+
+/**
+ * @brief Construct a new Engine object, plans the terms of the special mode.
+ * @param params The Parameters object.
+ */
+Engine::Engine(Parameters *params):params(params),t(1 + params->firstStep){
+    // Number of smoothing and differencing passes per dimension of the batch (z, y, x, t)
+    passes[0] = (params->is4D) ? params->kz - 1 : 0;
+    passes[1] = params->ky - 1;
+    passes[2] = params->kx - 1;
+    passes[3] = params->kt - 1;
+    planTerms();
+
+    // The hulls of every threshold follow each other
+    size = (long) (params->height - passes[1]) * (params->width - passes[2]) * (params->depth - passes[0]) * params->thresholds.size();
+}
+
+/**
+ * @brief Destroy the Engine object.
+ */
+Engine::~Engine(){
+}
+
+/**
+ * @brief Getter for Spatio-Temporal hulls.
+ * @return std::vector<float> The hulls laid out like the frames with z varying fastest, the hull of each threshold of a sweep one after the other.
+ */
+std::vector<float> Engine::getHulls(){
+    return normalise(getLabels(), size, t);
+}
+
+/**
+ * @brief This function turns labels into hulls, so that the latest time step is 0xFF.
+ * It needs no engine, so merged partial hulls are normalised without initialising a device.
+ * @param labels The labels.
+ * @param size The number of labels.
+ * @param t The label the next time step would get.
+ * @return std::vector<float> The hulls.
+ */
+std::vector<float> Engine::normalise(const float *labels, long size, int t){
+    std::vector<float> hulls(labels, labels + size);
+
+    // t - 1 time slices have been labelled, so the length of the time series does not need to be known upfront
+    for (float &value : hulls) value = value / (t - 1) * 0xFF;
+    return hulls;
+}
+
+/**
+ * @brief Getter for the number of values in the hulls.
+ * @return long The size of the hulls.
+ */
+long Engine::getSize(){
+    return size;
+}
+
+/**
+ * @brief Getter for the label the next time step gets.
+ * @return int The time pointer.
+ */
+int Engine::getTime(){
+    return t;
+}
+
+/**
+ * @brief This function creates the engine chosen in the parameters.
+ * @param params The Parameters object.
+ * @return Engine* The engine, to be deleted by the caller.
+ */
+Engine *Engine::create(Parameters *params){
+#ifdef BP_ARRAYFIRE
+    if (params->engine == ENGINE_ARRAYFIRE) return new Calc(params);
+#endif
+    return new Native(params);
+}
+
+/**
+ * @brief This function fits a cascade of three box filters to the binomial of a number of smoothing passes, for box filter mode.
+ * The cascade's support is centred in the binomial's, the widths are searched exhaustively for the taps closest to the binomial's.
+ * @param passes The number of smoothing passes the cascade replaces.
+ * @param widths The widths of the three boxes.
+ * @param offset The number of voxels the cascade's support starts after the binomial's.
+ * @param gain The factor that gives the cascade the sum of the binomial, 2^passes.
+ */
+void Engine::planBoxes(int passes, int widths[3], int &offset, float &gain){
+    std::vector<double> binomial(passes + 1, 0.0), cascade(passes + 1);
+    binomial[0] = 1;
+    for (int p = 0; p < passes; p++)
+        for (int j = p + 1; j >= 0; j--) binomial[j] = (binomial[j] + ((j) ? binomial[j - 1] : 0)) / 2;
+
+    double best = 1e30;
+    for (int a = 1; 3 * a - 2 <= passes + 1; a++)
+        for (int b = a; a + 2 * b - 2 <= passes + 1; b++)
+            for (int c = b; a + b + c - 2 <= passes + 1; c++) {
+                int start = passes + 3 - a - b - c;
+                if (start % 2) continue;  // The support could not be centred
+
+                // Normalised taps of the cascade, each box is a running sum over the taps before it
+                std::fill(cascade.begin(), cascade.end(), 0.0);
+                cascade[start / 2] = 1;
+                for (int w : {a, b, c})
+                    for (int j = passes; j >= 0; j--)
+                        for (int i = 1; i < w && i <= j; i++) cascade[j] += cascade[j - i];
+                double error = 0, scale = 1.0 / ((double) a * b * c);
+                for (int j = 0; j <= passes; j++) error += (cascade[j] * scale - binomial[j]) * (cascade[j] * scale - binomial[j]);
+                if (error >= best) continue;
+
+                best = error;
+                widths[0] = a;
+                widths[1] = b;
+                widths[2] = c;
+                offset = start / 2;
+            }
+
+    gain = std::ldexp(1.0f, passes) / (widths[0] * widths[1] * widths[2]);
+}
@@ -0,0 +1,47 @@
+/**
+ * @file Engine.h
+ * @author Antonin Thioux (antonin.thioux@gmail.com)
+ * @brief Header file of Engine.cpp
+ * @date last modified at 2026-10-16
+ * @version 1.0
+ */
+
+#ifndef BP_ENGINE_H
+#define BP_ENGINE_H
+
+#include <vector>
+
+#include "Parameters.h"
+
+namespace HullComputation {
+    struct Term {  // A squared partial derivative, order[d] gives how often it is differentiated across dimension d
+        int order[4];
+        float weight;
+    };
+
+    class Engine {
+    protected:
+        Parameters *params;
+        int t;
+        long size;
+        int passes[4], dimensions[4];
+        std::vector<Term> terms;
+        void addTerm(int dev1, int dev2, int dev3, float weight);
+        void planTerms();
+
+    public:
+        Engine(Parameters *params);
+        virtual ~Engine();
+        virtual void process(const unsigned char *frames, int length) = 0;
+        virtual const float *getLabels() = 0;
+        virtual void resume(const float *labels, int t) = 0;
+        std::vector<float> getHulls();
+        long getSize();
+        int getTime();
+        static Engine *create(Parameters *params);
+        static void planBoxes(int passes, int widths[3], int &offset, float &gain);
+        static std::vector<float> normalise(const float *labels, long size, int t);
+    };
+}
+
+#endif
@@ -0,0 +1,116 @@
+/**
+ * @file FrameCache.cpp
+ * @author Antonin Thioux (antonin.thioux@gmail.com)
+ * @brief This file contains the logic for the process wide frame cache, which evicts the least recently used frames.
+ * @date last modified at 2026-10-16
+ * @version 1.0
+ */
+
+#include "FrameCache.h"
+
+#include <cstring>
+
+using namespace HullComputation;
+using namespace std;
+
+/**
+ * @brief Construct a new FrameCache object, the cache is disabled until it gets a budget.
+ */
+FrameCache::FrameCache():budget(0),used(0),hits(0),misses(0){}
+
+/**
+ * @brief Getter for the cache shared by every reader of the process.
+ * @return FrameCache& The shared cache.
+ */
+FrameCache &FrameCache::shared(){
+    static FrameCache cache;
+    return cache;
+}
+
+/**
+ * @brief This function sets the memory budget of the cache, evicting frames if it shrinks.
+ * @param bytes The maximum number of bytes of frames to keep.
+ */
+void FrameCache::setBudget(size_t bytes){
+    lock_guard<mutex> guard(lock);
+    budget = bytes;
+    while (used > budget) {
+        used -= entries[recency.back()].data.size();
+        entries.erase(recency.back());
+        recency.pop_back();
+    }
+}
+
+/**
+ * @brief This function drops every cached frame, for when the frame indices start referring to another region.
+ */
+void FrameCache::clear(){
+    lock_guard<mutex> guard(lock);
+    entries.clear();
+    recency.clear();
+    used = 0;
+}
+
+/**
+ * @brief This function copies a frame out of the cache.
+ * @param frame The index of the frame.
+ * @param destination Where to copy the frame to.
+ * @param n The number of bytes in a frame.
+ * @return true If the frame was cached.
+ */
+bool FrameCache::lookup(int frame, unsigned char *destination, size_t n){
+    lock_guard<mutex> guard(lock);
+    if (budget == 0) return false;
+
+    unordered_map<int, Entry>::iterator entry = entries.find(frame);
+    if (entry == entries.end() || entry->second.data.size() != n) {
+        misses++;
+        return false;
+    }
+
+    recency.splice(recency.begin(), recency, entry->second.position);
+    memcpy(destination, entry->second.data.data(), n);
+    hits++;
+    return true;
+}
+
+/**
+ * @brief This function adds a frame to the cache, evicting the least recently used frames to stay within budget.
+ * @param frame The index of the frame.
+ * @param data The frame.
+ * @param n The number of bytes in a frame.
+ */
+void FrameCache::insert(int frame, const unsigned char *data, size_t n){
+    lock_guard<mutex> guard(lock);
+    if (n > budget || entries.count(frame)) return;
+
+    while (used + n > budget) {
+        used -= entries[recency.back()].data.size();
+        entries.erase(recency.back());
+        recency.pop_back();
+    }
+
+    recency.push_front(frame);
+    Entry &entry = entries[frame];
+    entry.data.assign(data, data + n);
+    entry.position = recency.begin();
+    used += n;
+}
+
+/**
+ * @brief Getter for the number of lookups that found their frame.
+ * @return long The number of hits.
+ */
+long FrameCache::getHits(){
+    lock_guard<mutex> guard(lock);
+    return hits;
+}
+
+/**
+ * @brief Getter for the number of lookups that had to go to disk.
+ * @return long The number of misses.
+ */
+long FrameCache::getMisses(){
+    lock_guard<mutex> guard(lock);
+    return misses;
+}
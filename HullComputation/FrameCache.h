@@ -0,0 +1,46 @@
+/**
+ * @file FrameCache.h
+ * @author Antonin Thioux (antonin.thioux@gmail.com)
+ * @brief Header file of FrameCache.cpp
+ * @date last modified at 2026-10-16
+ * @version 1.0
+ */
+
+#ifndef BP_FRAMECACHE_H
+#define BP_FRAMECACHE_H
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace HullComputation {
+    class FrameCache {
+    private:
+        /**
+         * @brief A cached frame and its position in the recency list.
+         */
+        struct Entry {
+            std::vector<unsigned char> data;
+            std::list<int>::iterator position;
+        };
+
+        std::mutex lock;
+        std::list<int> recency;
+        std::unordered_map<int, Entry> entries;
+        size_t budget, used;
+        long hits, misses;
+        FrameCache();
+
+    public:
+        static FrameCache &shared();
+        void setBudget(size_t bytes);
+        void clear();
+        bool lookup(int frame, unsigned char *destination, size_t n);
+        void insert(int frame, const unsigned char *data, size_t n);
+        long getHits();
+        long getMisses();
+    };
+}
+
+#endif
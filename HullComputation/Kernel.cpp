@@ -0,0 +1,510 @@
+/**
+ * @file Kernel.cpp
+ * @author Antonin Thioux (antonin.thioux@gmail.com)
+ * @brief This file contains the logic for computing Spatio-Temporal Hulls natively, in one cache blocked sweep over tiles.
+ * @date last modified at 2026-10-16
+ * @version 1.0
+ */
+
+#include "Kernel.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cstring>
+
+#define KERNEL_TILE_Z 8 // Output voxels per tile, chosen so the buffers of a tile stay in the L2 cache
+#define KERNEL_TILE_Y 16
+#define KERNEL_TILE_X 16
+#define KERNEL_TILE_T 8
+#define KERNEL_TASK_T 32 // Output time steps per task, tasks are a spatial tile by a range of time steps
+
+using namespace HullComputation;
+using std::vector;
+using std::min;
+using std::max;
+
+namespace {
+    template <int K>
+    struct Taps {  // The coefficients of a stencil, tap j weighs the voxel j further along the dimension
+        float c[K];
+    };
+
+    /**
+     * @brief This function computes the taps of a K long stencil of derivative order O at compile time,
+     * which is K - 1 - O smoothing passes (1, 1) and O differencing passes (1, -1) convolved together.
+     * @return Taps<K> The binomial coefficients of the stencil.
+     */
+    template <int K, int O>
+    constexpr Taps<K> binomial(){
+        Taps<K> taps = {};
+        taps.c[0] = 1;
+        for (int p = 0; p < K - 1; p++) {
+            float sign = (p < K - 1 - O) ? 1 : -1;
+            for (int j = p + 1; j > 0; j--) taps.c[j] += sign * taps.c[j - 1];
+        }
+        return taps;
+    }
+}
+
+/**
+ * @brief This function turns the tree of filter passes the terms share into a list of steps, in depth first order.
+ * A step at depth reads the buffer of its parent and overwrites the one at depth + 1, which none of the steps still to come
+ * for the parent's other branches need.
+ * @param group The terms that share the passes made so far.
+ * @param level The number of dimensions filtered so far.
+ * @param step The number of passes made across the current dimension.
+ * @param depth The number of passes made so far.
+ * @param last The index of the last step of the group, which the completed terms add their weight to.
+ */
+void Kernel::plan(const vector<Term> &group, int level, int step, int depth, int last){
+    if (level == 4) {
+        if (last < 0) return;  // A group that made no step has nothing to weigh
+        for (const Term &term : group) steps[last].weight += term.weight;
+        return;
+    }
+
+    int dim = dimensions[level];
+    if (step == passes[dim]) {
+        plan(group, level + 1, 0, depth, last);
+        return;
+    }
+    if (isBoxed(dim)) {  // Box filtered dimensions take a single step per order, next to the passes of the others
+        for (int order = 0; order <= passes[dim]; order++) {
+            vector<Term> matching;
+            for (const Term &term : group)
+                if (term.order[dim] == order) matching.push_back(term);
+            if (matching.empty()) continue;
+            steps.push_back(boxStep(depth, dim, order));
+            plan(matching, level + 1, 0, depth + 1, steps.size() - 1);
+        }
+        return;
+    }
+
+    vector<Term> smoothed, differenced;
+    for (const Term &term : group) {
+        if (step < passes[dim] - term.order[dim]) smoothed.push_back(term);
+        else differenced.push_back(term);
+    }
+
+    if (!smoothed.empty()) {
+        steps.push_back({depth, dim, 1, 0, &stencil<2, 0>, {}});
+        plan(smoothed, level, step + 1, depth + 1, steps.size() - 1);
+    }
+    if (!differenced.empty()) {
+        steps.push_back({depth, dim, 1, 0, &stencil<2, 1>, {}});
+        plan(differenced, level, step + 1, depth + 1, steps.size() - 1);
+    }
+}
+
+/**
+ * @brief This function turns the tree of stencils the terms share into a list of steps, in depth first order.
+ * Every dimension is filtered by a single unrolled stencil per distinct order, so a term reads and writes its buffers
+ * once per dimension rather than once per pass.
+ * @param group The terms that share the stencils applied so far.
+ * @param level The number of dimensions filtered so far.
+ * @param depth The number of stencils applied so far.
+ * @param last The index of the last step of the group, which the completed terms add their weight to.
+ */
+void Kernel::planStencils(const vector<Term> &group, int level, int depth, int last){
+    if (level == 4) {
+        if (last < 0) return;  // A group that made no step has nothing to weigh
+        for (const Term &term : group) steps[last].weight += term.weight;
+        return;
+    }
+
+    int dim = dimensions[level];
+    if (passes[dim] == 0) {  // Singleton dimensions of 3D data are not filtered
+        planStencils(group, level + 1, depth, last);
+        return;
+    }
+
+    for (int order = 0; order <= passes[dim]; order++) {
+        vector<Term> matching;
+        for (const Term &term : group)
+            if (term.order[dim] == order) matching.push_back(term);
+        if (matching.empty()) continue;
+
+        // In box filter mode large kernels are a cascade of running sums instead, like in Calc
+        if (isBoxed(dim)) steps.push_back(boxStep(depth, dim, order));
+        else steps.push_back({depth, dim, passes[dim], 0, select(passes[dim] + 1, order), {}});
+        planStencils(matching, level + 1, depth + 1, steps.size() - 1);
+    }
+}
+
+/**
+ * @brief This function makes the step filtering a dimension by a cascade of running sums, for a single derivative order.
+ * @param depth The number of steps applied before it.
+ * @param dim The dimension to filter across.
+ * @param order The derivative order across the dimension.
+ * @return Step The box filter step.
+ */
+Kernel::Step Kernel::boxStep(int depth, int dim, int order){
+    Step step = {depth, dim, passes[dim], 0, nullptr, {}};
+    step.box.order = order;
+    Engine::planBoxes(passes[dim] - order, step.box.widths, step.box.offset, step.box.gain);
+    return step;
+}
+
+/**
+ * @brief This function checks whether a dimension is filtered by running sums, which box filter mode does for kernels of BOX_MIN_SIZE and up.
+ * @param dim The dimension.
+ * @return true If the dimension is box filtered.
+ */
+bool Kernel::isBoxed(int dim){
+    return params->isBoxFiltered && passes[dim] + 1 >= BOX_MIN_SIZE;
+}
+
+/**
+ * @brief This function checks whether every dimension is computed in a single step, by an unrolled stencil for kernel sizes 3 and 5 or by running sums.
+ * @param terms The terms summed into the spacetime measure.
+ * @return true If the terms can be computed by stencils.
+ */
+bool Kernel::isSpecialized(const vector<Term> &terms){
+    for (int d = 0; d < 4; d++) {
+        if (passes[d] != 0 && passes[d] != 2 && passes[d] != 4 && !isBoxed(d)) return false;
+        for (const Term &term : terms)
+            if (term.order[d] > passes[d]) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief This function applies a K long stencil of derivative order O across a single dimension of a buffer.
+ * The taps are compile time constants, so the loop over them is unrolled and the loops over voxels vectorize.
+ * @param in The buffer to filter, laid out with z varying fastest.
+ * @param dims The dimensions of the buffer, the dimension filtered across is K - 1 shorter afterwards.
+ * @param result The filtered buffer.
+ * @param dim The dimension to filter across.
+ */
+template <int K, int O>
+void Kernel::stencil(const float *in, const int *dims, float *result, int dim){
+    constexpr Taps<K> taps = binomial<K, O>();
+    long inner = 1, outer = 1;
+    for (int d = 0; d < dim; d++) inner *= dims[d];
+    for (int d = dim + 1; d < 4; d++) outer *= dims[d];
+    int n = dims[dim] - K + 1;
+
+    if (inner == 1) {  // Neighbours are adjacent, also across y of 3D data whose z is a singleton
+        for (long o = 0; o < outer; o++) {
+            const float *a = in + o * (n + K - 1);
+            float *r = result + o * n;
+            for (int i = 0; i < n; i++) {
+                float value = taps.c[0] * a[i];
+                for (int j = 1; j < K; j++)
+                    if (taps.c[j] != 0) value += taps.c[j] * a[i + j];
+                r[i] = value;
+            }
+        }
+        return;
+    }
+
+    for (long o = 0; o < outer; o++) {
+        for (int m = 0; m < n; m++) {
+            const float *a = in + (o * (n + K - 1) + m) * inner;
+            float *r = result + (o * n + m) * inner;
+            for (long i = 0; i < inner; i++) {
+                float value = taps.c[0] * a[i];
+                for (int j = 1; j < K; j++)
+                    if (taps.c[j] != 0) value += taps.c[j] * a[i + j * inner];
+                r[i] = value;
+            }
+        }
+    }
+}
+
+/**
+ * @brief This function picks the instantiated stencil of a size and derivative order.
+ * @param size The length of the stencil, the kernel size.
+ * @param order The derivative order.
+ * @return Filter The stencil, or nullptr if it is not instantiated.
+ */
+Kernel::Filter Kernel::select(int size, int order){
+    switch (size * 8 + order) {
+        case 3 * 8 + 0: return &stencil<3, 0>;
+        case 3 * 8 + 1: return &stencil<3, 1>;
+        case 3 * 8 + 2: return &stencil<3, 2>;
+        case 5 * 8 + 0: return &stencil<5, 0>;
+        case 5 * 8 + 1: return &stencil<5, 1>;
+        case 5 * 8 + 2: return &stencil<5, 2>;
+        case 5 * 8 + 3: return &stencil<5, 3>;
+        case 5 * 8 + 4: return &stencil<5, 4>;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief This function applies a kernel across a single dimension of a buffer as its differencing passes followed by a cascade of boxes.
+ * Every box is a running sum, a voxel in and a voxel out per output voxel, so the cost does not depend on the kernel size.
+ * The running sums are exact on the integer frames, the last pass centres the cascade in the kernel and scales it to the binomial's sum.
+ * @param in The buffer to filter, laid out with z varying fastest.
+ * @param dims The dimensions of the buffer, the dimension filtered across is length shorter afterwards.
+ * @param result The filtered buffer.
+ * @param dim The dimension to filter across.
+ * @param length The number of passes of the kernel, its size minus one.
+ * @param box The cascade standing in for the smoothing passes.
+ */
+void Kernel::box(const float *in, const int *dims, float *result, int dim, int length, const Box &box){
+    long inner = 1, outer = 1;
+    for (int d = 0; d < dim; d++) inner *= dims[d];
+    for (int d = dim + 1; d < 4; d++) outer *= dims[d];
+    const int n = dims[dim], count = n - length;
+
+    // Lines across the dimension are filtered side by side, a plane of voxels at a time.
+    // Adjacent neighbours would make every running sum a serial chain, so those lines are transposed into a single plane first
+    const bool isTransposed = (inner == 1);
+    const long lines = (isTransposed) ? outer : inner, blocks = (isTransposed) ? 1 : outer;
+    thread_local vector<float> front, back;
+    front.resize(n * lines);
+    back.resize(n * lines);
+
+    for (long o = 0; o < blocks; o++) {
+        const float *source = in + o * n * lines;
+        if (isTransposed) {
+            for (long l = 0; l < lines; l++)
+                for (int m = 0; m < n; m++) front[m * lines + l] = in[l * n + m];
+            source = front.data();
+        }
+
+        int m = n;
+        for (int d = 0; d < box.order; d++, m--) {
+            for (long i = 0; i < (m - 1) * lines; i++) back[i] = source[i] - source[i + lines];
+            front.swap(back);
+            source = front.data();
+        }
+
+        for (int w : box.widths) {
+            if (w == 1) continue;
+            float *target = back.data();
+            for (long i = 0; i < lines; i++) {
+                float value = 0;
+                for (int j = 0; j < w; j++) value += source[i + j * lines];
+                target[i] = value;
+            }
+            for (int k = 1; k <= m - w; k++) {
+                const float *enter = source + (k + w - 1) * lines, *leave = source + (k - 1) * lines;
+                const float *previous = target + (k - 1) * lines;
+                float *current = target + k * lines;
+                for (long i = 0; i < lines; i++) current[i] = previous[i] + enter[i] - leave[i];
+            }
+            m -= w - 1;
+            front.swap(back);
+            source = front.data();
+        }
+
+        const float *centre = source + box.offset * lines;
+        if (isTransposed) {
+            for (long l = 0; l < lines; l++)
+                for (int k = 0; k < count; k++) result[l * count + k] = box.gain * centre[k * lines + l];
+        }
+        else {
+            float *r = result + o * count * lines;
+            for (long i = 0; i < count * lines; i++) r[i] = box.gain * centre[i];
+        }
+    }
+}
+
+/**
+ * @brief This function checks whether the input of a tile, its halo included, is the same in a run of frames.
+ * Every time step computed from such a run then has the same measure, so only the latest one can end up in the hulls.
+ * @param window The frames of the window, laid out frame after frame.
+ * @param tile The output size of the tile.
+ * @param z0 The first output z of the tile.
+ * @param y0 The first output y of the tile.
+ * @param x0 The first output x of the tile.
+ * @param first The first frame of the run.
+ * @param frames The number of frames in the run.
+ * @return true If none of the frames differ from the first inside the tile.
+ */
+bool Kernel::isStatic(const unsigned char *window, const int *tile, int z0, int y0, int x0, int first, int frames){
+    const long frameSize = (long) size[0] * size[1] * size[2];
+    const int extent[3] = {tile[0] + passes[0], tile[1] + passes[1], tile[2] + passes[2]};
+
+    for (int x = 0; x < extent[2]; x++)
+        for (int y = 0; y < extent[1]; y++) {
+            const unsigned char *reference = window + first * frameSize + z0 + size[0] * (y0 + y + (long) size[1] * (x0 + x));
+            for (int f = 1; f < frames; f++)
+                if (memcmp(reference + f * frameSize, reference, extent[0])) return false;
+        }
+    return true;
+}
+
+/**
+ * @brief This function computes the hulls of a single spatial tile over a range of time steps, a block of time steps at a time.
+ * The block is read from the window once, all terms are computed from it in buffers private to the thread,
+ * then their sum is thresholded, labelled and reduced into the partial hulls of the worker, once per threshold of a sweep.
+ * Where the tile does not change, only the latest time step of the range or block is computed.
+ * @param window The frames of the window, laid out frame after frame.
+ * @param t The label of the first time step of the window.
+ * @param z0 The first output z of the tile.
+ * @param y0 The first output y of the tile.
+ * @param x0 The first output x of the tile.
+ * @param first The first output time step of the range.
+ * @param last The output time step after the range.
+ */
+void Kernel::processTile(const unsigned char *window, int t, int z0, int y0, int x0, int first, int last){
+    const int tile[3] = {min(KERNEL_TILE_Z, out[0] - z0), min(KERNEL_TILE_Y, out[1] - y0), min(KERNEL_TILE_X, out[2] - x0)};
+    const long frameSize = (long) size[0] * size[1] * size[2];
+    const long voxels = (long) tile[0] * tile[1] * tile[2];
+    const long capacity = (long) (tile[0] + passes[0]) * (tile[1] + passes[1]) * (tile[2] + passes[2]) * (KERNEL_TILE_T + passes[3]);
+    const int sweep = thresholds.size();
+
+    thread_local vector<float> scratch;
+    scratch.resize(capacity * (depths + 1) + voxels * KERNEL_TILE_T);
+    float *sum = scratch.data() + capacity * (depths + 1);
+    vector<int> dims(4 * (depths + 1));
+
+    thread_local vector<float> labels;
+    labels.assign(voxels * sweep, 0.0f);
+
+    // Static parts of the volume cost a single time step, so the work scales with the motion in the data
+    if (isStatic(window, tile, z0, y0, x0, first, last - first + passes[3])) first = last - 1;
+
+    for (int t0 = first, count = 0; t0 < last; t0 += count) {
+        count = min(KERNEL_TILE_T, last - t0);
+        if (count > 1 && isStatic(window, tile, z0, y0, x0, t0, count + passes[3])) {
+            t0 += count - 1;
+            count = 1;
+        }
+        int *root = dims.data();
+        root[0] = tile[0] + passes[0];
+        root[1] = tile[1] + passes[1];
+        root[2] = tile[2] + passes[2];
+        root[3] = count + passes[3];
+
+        // Gather the block with its halo, z is contiguous in both the frames and the block
+        float *block = scratch.data();
+        for (int f = 0; f < root[3]; f++)
+            for (int x = 0; x < root[2]; x++)
+                for (int y = 0; y < root[1]; y++) {
+                    const unsigned char *source = window + (t0 + f) * frameSize + z0 + size[0] * (y0 + y + (long) size[1] * (x0 + x));
+                    float *destination = block + root[0] * (y + (long) root[1] * (x + (long) root[2] * f));
+                    for (int z = 0; z < root[0]; z++) destination[z] = source[z];
+                }
+
+        // Walk the tree of passes, every completed term is squared into the sum
+        bool first = true;
+        for (const Step &step : steps) {
+            const int *in = dims.data() + 4 * step.depth;
+            int *result = dims.data() + 4 * (step.depth + 1);
+            float *target = scratch.data() + capacity * (step.depth + 1);
+            if (step.apply) step.apply(scratch.data() + capacity * step.depth, in, target, step.dim);
+            else box(scratch.data() + capacity * step.depth, in, target, step.dim, step.length, step.box);
+            for (int d = 0; d < 4; d++) result[d] = in[d] - ((d == step.dim) ? step.length : 0);
+            if (step.weight == 0) continue;
+
+            long n = voxels * count;
+            float w = step.weight;
+            if (first) for (long i = 0; i < n; i++) sum[i] = w * target[i] * target[i];
+            else for (long i = 0; i < n; i++) sum[i] += w * target[i] * target[i];
+            first = false;
+        }
+
+        // The sum is laid out like the tile with time last, so the latest time step above the threshold is kept
+        for (int i = 0; i < sweep; i++) {
+            float threshold = thresholds[i], *label = labels.data() + voxels * i;
+            for (int s = 0; s < count; s++) {
+                const float *slice = sum + voxels * s;
+                float value = t + t0 + s;
+                for (long v = 0; v < voxels; v++)
+                    if (slice[v] >= threshold && slice[v] > unit) label[v] = value;
+            }
+        }
+    }
+
+    vector<float> &partial = partials[pool->worker()];
+    if (partial.empty()) partial.assign(hulls.size(), 0.0f);
+
+    // The hulls of a sweep follow each other, like the last dimension of the arrayfire hulls
+    const long outSize = (long) out[0] * out[1] * out[2];
+    for (int i = 0; i < sweep; i++)
+        for (int x = 0; x < tile[2]; x++)
+            for (int y = 0; y < tile[1]; y++) {
+                float *hull = partial.data() + outSize * i + z0 + (long) out[0] * (y0 + y + (long) out[1] * (x0 + x));
+                const float *label = labels.data() + voxels * i + tile[0] * (y + tile[1] * x);
+                for (int z = 0; z < tile[0]; z++) hull[z] = max(hull[z], label[z]);
+            }
+}
+
+/**
+ * @brief Construct a new Kernel object, plans the passes the terms share.
+ * @param params The Parameters object.
+ * @param terms The terms summed into the spacetime measure.
+ * @param dimensions The order the dimensions are filtered in.
+ * @param passes The number of passes per dimension of the batch (z, y, x, t).
+ */
+Kernel::Kernel(Parameters *params, const vector<Term> &terms, const int dimensions[4], const int passes[4]):params(params),pool(new ThreadPool()){
+    for (int d = 0; d < 4; d++) {
+        this->dimensions[d] = dimensions[d];
+        this->passes[d] = passes[d];
+    }
+
+    // Kernel sizes of 3 and 5 apply whole unrolled stencils, other sizes fall back to a pass at a time unless they are box filtered
+    if (isSpecialized(terms)) planStencils(terms, 0, 0, -1);
+    else plan(terms, 0, 0, 0, -1);
+    depths = 0;
+    for (const Step &step : steps) depths = max(depths, step.depth + 1);
+
+    size[0] = params->depth;
+    size[1] = params->height;
+    size[2] = params->width;
+    for (int d = 0; d < 3; d++) out[d] = size[d] - passes[d];
+    hulls.assign((long) out[0] * out[1] * out[2] * params->thresholds.size(), 0.0f);
+    partials.resize(pool->size());
+
+    // Frames are not divided by 0xFF, so the thresholds and the labelling cutoff of 1 are scaled up instead
+    for (int threshold : params->thresholds) {
+        float value = threshold * params->gain * 0xFF;
+        thresholds.push_back(value * value);
+    }
+    unit = 0xFF * 0xFF;
+}
+
+/**
+ * @brief Destroy the Kernel object.
+ */
+Kernel::~Kernel(){
+    delete pool;
+}
+
+/**
+ * @brief This function reduces a window of frames into the hulls, as tasks of a spatial tile by a range of time steps.
+ * The tasks are scheduled on a work stealing pool, each worker reduces into its own partial hulls so tasks need no synchronisation.
+ * @param window The frames of the window as u8, laid out frame after frame.
+ * @param length The number of frames in the window.
+ * @param t The label of the first time step of the window.
+ */
+void Kernel::process(const unsigned char *window, int length, int t){
+    int steps = length - passes[3];
+    for (int t0 = 0; t0 < steps; t0 += KERNEL_TASK_T)
+        for (int x0 = 0; x0 < out[2]; x0 += KERNEL_TILE_X)
+            for (int y0 = 0; y0 < out[1]; y0 += KERNEL_TILE_Y)
+                for (int z0 = 0; z0 < out[0]; z0 += KERNEL_TILE_Z)
+                    pool->submit([=]{ processTile(window, t, z0, y0, x0, t0, min(steps, t0 + KERNEL_TASK_T)); });
+    pool->wait();
+}
+
+/**
+ * @brief Getter for the hulls, labelled with the latest time step.
+ * The partial hulls of the workers are merged by element-wise max, in parallel over slices of the hulls.
+ * @return const float* The hulls laid out like the frames, the hulls of a sweep one after the other.
+ */
+const float *Kernel::getHulls(){
+    long n = hulls.size(), slice = (n + pool->size() - 1) / pool->size();
+    for (long begin = 0; begin < n; begin += slice)
+        pool->submit([=]{
+            long end = min(n, begin + slice);
+            for (const vector<float> &partial : partials)
+                if (!partial.empty())
+                    for (long i = begin; i < end; i++) hulls[i] = max(hulls[i], partial[i]);
+        });
+    pool->wait();
+    return hulls.data();
+}
+
+/**
+ * @brief Setter for the hulls, to continue from the labels of a previous run.
+ * @param labels The labels laid out like the frames.
+ */
+void Kernel::setHulls(const float *labels){
+    hulls.assign(labels, labels + hulls.size());
+}
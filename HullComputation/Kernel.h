@@ -0,0 +1,63 @@
+/**
+ * @file Kernel.h
+ * @author Antonin Thioux (antonin.thioux@gmail.com)
+ * @brief Header file of Kernel.cpp
+ * @date last modified at 2026-10-16
+ * @version 1.0
+ */
+
+#ifndef BP_KERNEL_H
+#define BP_KERNEL_H
+
+#include <vector>
+
+#include "Parameters.h"
+#include "Engine.h"
+
+namespace HullComputation {
+    class ThreadPool;
+
+    class Kernel {
+    private:
+        typedef void (*Filter)(const float *in, const int *dims, float *result, int dim);
+        struct Box {  // A cascade of running sums standing in for the smoothing passes of a large kernel, see Engine::planBoxes
+            int order, widths[3], offset;
+            float gain;
+        };
+        struct Step {  // A filter from the buffer at depth into the one at depth + 1, length passes long, completed terms carry their weight
+            int depth, dim, length;
+            float weight;
+            Filter apply;  // nullptr for a box cascade
+            Box box;
+        };
+
+        Parameters *params;
+        ThreadPool *pool;
+        int passes[4], dimensions[4], size[3], out[3];
+        int depths;
+        float unit;
+        std::vector<float> thresholds;
+        std::vector<Step> steps;
+        std::vector<float> hulls;
+        std::vector<std::vector<float>> partials;
+        void plan(const std::vector<Term> &group, int level, int step, int depth, int last);
+        void planStencils(const std::vector<Term> &group, int level, int depth, int last);
+        Step boxStep(int depth, int dim, int order);
+        bool isBoxed(int dim);
+        bool isSpecialized(const std::vector<Term> &terms);
+        template <int K, int O> static void stencil(const float *in, const int *dims, float *result, int dim);
+        static Filter select(int size, int order);
+        static void box(const float *in, const int *dims, float *result, int dim, int length, const Box &box);
+        bool isStatic(const unsigned char *window, const int *tile, int z0, int y0, int x0, int first, int frames);
+        void processTile(const unsigned char *window, int t, int z0, int y0, int x0, int first, int last);
+
+    public:
+        Kernel(Parameters *params, const std::vector<Term> &terms, const int dimensions[4], const int passes[4]);
+        ~Kernel();
+        void process(const unsigned char *window, int length, int t);
+        const float *getHulls();
+        void setHulls(const float *labels);
+    };
+}
+
+#endif
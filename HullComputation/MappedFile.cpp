@@ -0,0 +1,83 @@
+/**
+ * @file MappedFile.cpp
+ * @author Antonin Thioux (antonin.thioux@gmail.com)
+ * @brief This file contains the logic for mapping binary data files into memory.
+ * @date last modified at 2026-10-16
+ * @version 1.0
+ */
+
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace HullComputation;
+using namespace std;
+
+/**
+ * @brief Construct a new MappedFile object, the file is mapped read only and hinted for sequential access.
+ * When only a range of the file is needed, read ahead is turned off and only the pages of that range are hinted.
+ * @param filename The path to the file.
+ * @param minimum The minimum number of bytes the file should contain.
+ * @param offset The first byte of the range that will be read.
+ * @param span The number of bytes in the range, 0 for the whole file.
+ */
+MappedFile::MappedFile(string filename, size_t minimum, size_t offset, size_t span):data(nullptr),size(0){
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        cerr << "file: " << filename << " not found!" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) < 0 || (size_t) info.st_size < minimum) {
+        cerr << "file: " << filename << " is too small, expected " << minimum << " bytes!" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    size = info.st_size;
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // The mapping keeps its own reference to the file
+    if (mapping == MAP_FAILED) {
+        cerr << "file: " << filename << " could not be mapped!" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    data = (unsigned char *) mapping;
+    if (span == 0 || span >= size) {
+        madvise(mapping, size, MADV_SEQUENTIAL);
+        madvise(mapping, size, MADV_WILLNEED);
+        return;
+    }
+
+    // Hints must start on a page boundary
+    size_t page = sysconf(_SC_PAGESIZE), first = offset / page * page;
+    madvise(mapping, size, MADV_RANDOM);
+    madvise(data + first, min(size, offset + span) - first, MADV_WILLNEED);
+}
+
+/**
+ * @brief Destroy the MappedFile object, unmaps the file.
+ */
+MappedFile::~MappedFile(){
+    if (data) munmap(data, size);
+}
+
+/**
+ * @brief Getter for the mapped bytes of the file.
+ * @return const unsigned char* Pointer to the start of the mapping.
+ */
+const unsigned char *MappedFile::bytes() const {
+    return data;
+}
+
+/**
+ * @brief Getter for the size of the mapping.
+ * @return size_t The number of bytes mapped.
+ */
+size_t MappedFile::length() const {
+    return size;
+}
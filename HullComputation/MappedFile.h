@@ -0,0 +1,31 @@
+/**
+ * @file MappedFile.h
+ * @author Antonin Thioux (antonin.thioux@gmail.com)
+ * @brief Header file of MappedFile.cpp
+ * @date last modified at 2026-10-16
+ * @version 1.0
+ */
+
+#ifndef BP_MAPPEDFILE_H
+#define BP_MAPPEDFILE_H
+
+#include <iostream>
+#include <string>
+
+namespace HullComputation {
+    class MappedFile {
+    private:
+        unsigned char *data;
+        size_t size;
+
+    public:
+        MappedFile(std::string filename, size_t minimum, size_t offset = 0, size_t span = 0);
+        ~MappedFile();
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+        const unsigned char *bytes() const;
+        size_t length() const;
+    };
+}
+
+#endif
@@ -0,0 +1,54 @@
+/**
+ * @file Native.cpp
+ * @author Antonin Thioux (antonin.thioux@gmail.com)
+ * @brief This file contains the native engine, which computes the hulls on the host in plain C++ without ArrayFire.
+ * @date last modified at 2026-10-16
+ * @version 1.0
+ */
+
+#include "Native.h"
+
+using namespace HullComputation;
+
+/**
+ * @brief Construct a new Native object, plans the kernel the terms share.
+ * @param params The Parameters object.
+ */
+Native::Native(Parameters *params):Engine(params){
+    kernel = new Kernel(params, terms, dimensions, passes);
+}
+
+/**
+ * @brief Destroy the Native object.
+ */
+Native::~Native(){
+    delete kernel;
+}
+
+/**
+ * @brief This function reduces a window of frames into the hulls, the kernel fuses the whole pipeline into one sweep over the frames.
+ * @param frames The frames of the window as u8, laid out frame after frame.
+ * @param length The number of frames in the window.
+ */
+void Native::process(const unsigned char *frames, int length){
+    kernel->process(frames, length, t);
+    t += length - params->kt + 1;
+}
+
+/**
+ * @brief Getter for the hulls before normalisation, each voxel holds the latest time step it was above the threshold.
+ * @return const float* The labels laid out like the frames.
+ */
+const float *Native::getLabels(){
+    return kernel->getHulls();
+}
+
+/**
+ * @brief This function continues from the labels and time pointer of a previous run.
+ * @param labels The labels laid out like the frames.
+ * @param t The time pointer.
+ */
+void Native::resume(const float *labels, int t){
+    kernel->setHulls(labels);
+    this->t = t;
+}
@@ -0,0 +1,29 @@
+/**
+ * @file Native.h
+ * @author Antonin Thioux (antonin.thioux@gmail.com)
+ * @brief Header file of Native.cpp
+ * @date last modified at 2026-10-16
+ * @version 1.0
+ */
+
+#ifndef BP_NATIVE_H
+#define BP_NATIVE_H
+
+#include "Engine.h"
+#include "Kernel.h"
+
+namespace HullComputation {
+    class Native : public Engine {
+    private:
+        Kernel *kernel;
+
+    public:
+        Native(Parameters *params);
+        ~Native();
+        void process(const unsigned char *frames, int length);
+        const float *getLabels();
+        void resume(const float *labels, int t);
+    };
+}
+
+#endif
@@ -8,10 +8,16 @@
 
 #include "Parameters.h"
 
+#include <algorithm>
+#include <climits>
+#include <thread>
+#include <cmath>
+
 #define DEFAULT_GRAYSCALE 0
 #define DEFAULT_VIEW_SLICE -1 // -1 isn't a valid value it should be overwritten
 #define DEFAULT_TIMER 0
 #define DEFAULT_BATCHES 1
+#define DEFAULT_WINDOW 0 // 0 means the window is derived from the number of batches
 #define DEFAULT_KERNEL_SIZE_X 3
 #define DEFAULT_KERNEL_SIZE_Y 3
 #define DEFAULT_KERNEL_SIZE_Z 3
@@ -19,15 +25,41 @@
 #define DEFAULT_THRESHOLD 100
 #define DEFAULT_EXPORT_ANIMATION 0
 #define DEFAULT_SPECIAL 0
+#define DEFAULT_CACHE_SIZE 512
+#define DEFAULT_LOW_PRECISION 0
+#define DEFAULT_SLIDING 0
+#define DEFAULT_BOX_FILTERED 0
+#ifdef BP_ARRAYFIRE
+#define DEFAULT_ENGINE ENGINE_ARRAYFIRE
+#else
+#define DEFAULT_ENGINE ENGINE_NATIVE // Builds without ArrayFire only have the native engine
+#endif
+#define DEFAULT_MEMORY_BUDGET 0 // 0 means the window is not derived from a memory budget
+#define DEFAULT_SNAPSHOT_EVERY 0 // 0 means only the final hulls are written
+#define DEFAULT_PYRAMID 0 // 0 means no preview levels are computed
+#define DEFAULT_LEVEL 0 // 0 means full resolution
+#define STREAM_WINDOW_FACTOR 4 // Streams default to a window of this many times the kernel t size
 
 using namespace HullComputation;
 using namespace std;
 
 /**
- * @brief This function parses data dimension files to extract its parameters.
+ * @brief This function parses data dimension files to extract its parameters, containers carry them in their header.
  * @param filename The path to file.
  */
 void Parameters::parseFile(string filepath){
+    if (Container::isContainer(filepath)) {
+        Container data(filepath);
+        width = data.getWidth();
+        height = data.getHeight();
+        depth = data.getDepth();
+        duration = data.getFrames();
+        is4D = (depth != 1);
+        datafiles = nullptr;
+        container = filepath;
+        return;
+    }
+
     file.open(filepath);
     if (!file) printError("File not found!");
     
@@ -40,11 +72,12 @@ void Parameters::parseFile(string filepath){
     is4D = (depth != 1);
     ss.clear();
 
+    duration = 0;  // Dimension files for streams may leave out the frames
     getline(file, line);
     ss << line;
     ss >> duration;
 
-    datafiles = (string *) malloc(sizeof(string) * duration);
+    datafiles = new string[duration];
     string path = filepath.substr(0, filepath.rfind('/') + 1);
     for (int i = 0; i < duration; i++) {
         getline(file, line);
@@ -66,40 +99,388 @@ void Parameters::parseOptions(int n, char **options) {
         else if (flag == "-gs" || flag == "--gray-scale") isViewed = 1;
         else if (flag == "--view-slice") sscanf(options[++i], "%d", &viewSlice);
         else if (flag == "-b" || flag == "--batches") sscanf(options[++i], "%d", &batches);
-        else if (flag == "-th" || flag == "--threshold") sscanf(options[++i], "%d", &threshold);
+        else if (flag == "-w" || flag == "--window") sscanf(options[++i], "%d", &window);
+        else if (flag == "-th" || flag == "--threshold") parseThresholds(options[++i]);
         else if (flag == "-kx" || flag == "--kernel-x-size") sscanf(options[++i], "%d", &kx);
         else if (flag == "-ky" || flag == "--kernel-y-size") sscanf(options[++i], "%d", &ky);
         else if (flag == "-kz" || flag == "--kernel-z-size") sscanf(options[++i], "%d", &kz);
         else if (flag == "-kt" || flag == "--kernel-t-size") sscanf(options[++i], "%d", &kt);
         else if (flag == "-ea" || flag == "--export-animation") exportAnimation = 1;
         else if (flag == "-s" || flag == "--special") sscanf(options[++i], "%d", &special);
+        else if (flag == "-lp" || flag == "--low-precision") isLowPrecision = 1;
+        else if (flag == "--sliding") isSliding = 1;
+        else if (flag == "--box-filter") isBoxFiltered = 1;
+        else if (flag == "--roi-x") sscanf(options[++i], "%d:%d", &roi[0][0], &roi[0][1]);
+        else if (flag == "--roi-y") sscanf(options[++i], "%d:%d", &roi[1][0], &roi[1][1]);
+        else if (flag == "--roi-z") sscanf(options[++i], "%d:%d", &roi[2][0], &roi[2][1]);
+        else if (flag == "--roi-t") sscanf(options[++i], "%d:%d", &roi[3][0], &roi[3][1]);
+        else if (flag == "--stream") stream = string(options[++i]);
+        else if (flag == "--snapshot-every") sscanf(options[++i], "%d", &snapshotEvery);
+        else if (flag == "--time-range") parseTimeRange(options[++i]);
+        else if (flag == "--save-state") saveState = string(options[++i]);
+        else if (flag == "--resume") resume = string(options[++i]);
+        else if (flag == "--brick") sscanf(options[++i], "%d,%d,%d", &brick[0], &brick[1], &brick[2]);
+        else if (flag == "--pyramid") sscanf(options[++i], "%d", &pyramid);
+        else if (flag == "--level") sscanf(options[++i], "%d", &level);
+        else if (flag == "-e" || flag == "--engine") engine = parseEngine(options[++i]);
+        else if (flag == "-mb" || flag == "--memory-budget") sscanf(options[++i], "%d", &memoryBudget);
+        else if (flag == "-cs" || flag == "--cache-size") sscanf(options[++i], "%d", &cacheSize);
         else printError("Unknown flag!");
     }
 }
 
+/**
+ * @brief This function parses the name of a compute engine.
+ * @param name The name given on the command line.
+ * @return int The engine.
+ */
+int Parameters::parseEngine(string name){
+#ifdef BP_ARRAYFIRE
+    if (name == "af" || name == "arrayfire") return ENGINE_ARRAYFIRE;
+#else
+    if (name == "af" || name == "arrayfire") printError("This build has no ArrayFire engine!");
+#endif
+    if (name == "native") return ENGINE_NATIVE;
+    printError("Unknown engine!");
+    return DEFAULT_ENGINE;
+}
+
+/**
+ * @brief This function parses a comma separated list of thresholds, the first one is the threshold of the main hulls.
+ * @param list The list given on the command line.
+ */
+void Parameters::parseThresholds(string list){
+    thresholds.clear();
+    std::stringstream stream(list);
+    string value;
+    while (std::getline(stream, value, ','))
+        thresholds.push_back(atoi(value.c_str()));
+    if (thresholds.empty()) printError("No threshold given!");
+    threshold = thresholds[0];
+}
+
+/**
+ * @brief This function parses a time range a:b, a left out start is the first time step and a left out end is past the last one.
+ * @param range The range given on the command line.
+ */
+void Parameters::parseTimeRange(string range){
+    size_t colon = range.find(':');
+    if (colon == string::npos) printError("Invalid time range!");
+    timeRange[0] = (colon == 0) ? 0 : atoi(range.substr(0, colon).c_str());
+    timeRange[1] = (colon + 1 == range.size()) ? INT_MAX : atoi(range.substr(colon + 1).c_str());
+}
+
+/**
+ * @brief This function checks the options that conflict with streamed frames, whose number is not known upfront.
+ * Only the dimensions of the dimension file are used, the frames it lists are ignored.
+ */
+void Parameters::checkStream(){
+    if (!container.empty()) printError("Streams need a dimension file, not a container!");
+    if (isViewed) printError("Grayscale view is not available for streams!");
+    if (exportAnimation) printError("Animation export is not available for streams!");
+    if (roi[3][0] != -1) printError("Region of interest in t given for a stream!");
+    if (brick[0] || brick[1] || brick[2]) printError("Bricks are not available for streams, they read the frames once per brick!");
+    if (timeRange[0] != -1) printError("Time ranges are not available for streams!");
+    duration = 0;
+}
+
+/**
+ * @brief This function narrows the data dimensions to the region of interest, grown by the halo the kernels need.
+ * The full dimensions and the offset of the region are kept for reading.
+ */
+void Parameters::applyRegion(){
+    int *sizes[4] = {&width, &height, &depth, &duration};
+    int *offsets[4] = {&offsetX, &offsetY, &offsetZ, &offsetT};
+    const int kernels[4] = {kx, ky, (is4D) ? kz : 1, kt};
+    fullWidth = width;
+    fullHeight = height;
+    fullDepth = depth;
+    fullDuration = duration;
+
+    if (roi[2][0] != -1 && !is4D) printError("Region of interest in z given for 3D data!");
+    for (int d = 0; d < 4; d++) {
+        int begin = roi[d][0], end = roi[d][1];
+        *offsets[d] = 0;
+        if (begin == -1 && end == -1) continue;  // No region given, use the whole range
+        if (begin < 0 || end <= begin || end > *sizes[d]) printError("Invalid region of interest!");
+
+        begin = max(0, begin - (kernels[d] - 1) / 2);
+        end = min(*sizes[d], end + kernels[d] / 2);
+        *offsets[d] = begin;
+        *sizes[d] = end - begin;
+    }
+}
+
+/**
+ * @brief This function narrows the time series to a shard of time steps [a, b), which needs the frames [a, b + kt - 1).
+ * An end past the last time step, such as that of an open range, is clamped to it.
+ * Labels stay those of the whole time series, so the partial hulls of shards can be merged by max.
+ * Shards save their partial hulls instead of extracting them.
+ */
+void Parameters::applyTimeRange(){
+    firstStep = 0;
+    isSharded = (timeRange[0] != -1 || timeRange[1] != -1);
+    if (!isSharded) return;
+
+    if (roi[3][0] != -1) printError("Time range and region of interest in t given!");
+    if (!resume.empty()) printError("Time ranges can not be resumed!");
+    if (isViewed || exportAnimation) printError("Shards only save partial hulls, view and export them after merging!");
+
+    int steps = duration - kt + 1;
+    int begin = timeRange[0], end = std::min(timeRange[1], steps);
+    if (begin < 0 || end <= begin) printError("Invalid time range!");
+    offsetT = begin;
+    duration = end + kt - 1 - begin;
+    firstStep = begin;
+
+    if (saveState.empty()) {
+        stringstream ss;
+        ss << "hulls_" << begin << "_" << end << ".state";
+        saveState = ss.str();
+    }
+}
+
+/**
+ * @brief This function splits the hulls of the region into bricks of at most the given x, y and z size.
+ * Dimensions without a brick size, and z for 3D data, are not split.
+ */
+void Parameters::planBricks(){
+    int sizes[3] = {width, height, depth};
+    int offsets[3] = {offsetX, offsetY, offsetZ};
+    const int kernels[3] = {kx, ky, (is4D) ? kz : 1};
+
+    bricks = 1;
+    for (int d = 0; d < 3; d++) {
+        int out = sizes[d] - kernels[d] + 1;
+        if (brick[d] < 0) printError("Brick size can not be negative!");
+        if (brick[d] == 0 || brick[d] > out || (d == 2 && !is4D)) brick[d] = out;
+        bricks *= (out + brick[d] - 1) / brick[d];
+        regionOffset[d] = offsets[d];
+        regionSize[d] = sizes[d];
+    }
+    if (bricks > 1 && snapshotEvery) printError("Snapshots are not available for bricks!");
+    brickX = brickY = brickZ = 0;
+}
+
+/**
+ * @brief This function narrows the data dimensions to a single brick, grown by the (k - 1) halo the kernels need.
+ * The bricks are numbered with x varying fastest, -1 selects the whole region again.
+ * @param index The brick to select.
+ */
+void Parameters::selectBrick(int index){
+    int *sizes[3] = {&width, &height, &depth};
+    int *offsets[3] = {&offsetX, &offsetY, &offsetZ};
+    int *starts[3] = {&brickX, &brickY, &brickZ};
+    const int kernels[3] = {kx, ky, (is4D) ? kz : 1};
+    bool whole = (index == -1);
+
+    for (int d = 0; d < 3; d++) {
+        int out = regionSize[d] - kernels[d] + 1;
+        int n = (out + brick[d] - 1) / brick[d];
+        *starts[d] = (whole) ? 0 : (index % n) * brick[d];
+        if (!whole) index /= n;
+
+        int length = (whole) ? out : std::min(brick[d], out - *starts[d]);
+        *offsets[d] = regionOffset[d] + *starts[d];
+        *sizes[d] = length + kernels[d] - 1;
+    }
+}
+
+/**
+ * @brief This function checks the levels of the pyramid, each level halves the resolution of the one below it.
+ * A standalone level is selected right away, so the whole run is made at its resolution.
+ */
+void Parameters::planLevels(){
+    levelSize[0] = width;
+    levelSize[1] = height;
+    levelSize[2] = depth;
+    levelKernel[0] = kx;
+    levelKernel[1] = ky;
+    levelKernel[2] = kz;
+    scale = 1;
+    gain = 1;
+
+    if (pyramid < 0 || level < 0) printError("Pyramid levels can not be negative!");
+    if (pyramid && level) printError("Pyramid and level given!");
+    if (!pyramid && !level) return;
+    if (bricks > 1) printError("Pyramids are not available for bricks!");
+    if (isSharded || !saveState.empty() || !resume.empty()) printError("States are not available for pyramids!");
+    if (pyramid && isStreamed) printError("Pyramids are not available for streams, they read the frames once per level!");
+    if (pyramid && snapshotEvery) printError("Snapshots are not available for pyramids!");
+
+    selectLevel(std::max(pyramid, level));
+    if (kx > width || ky > height || (kz > depth && is4D)) printError("Pyramid level too coarse for the kernel sizes!");
+    selectLevel(level);
+}
+
+/**
+ * @brief This function narrows the data dimensions to a level of the pyramid, at 1 / 2^index of the resolution of the region.
+ * Kernel sizes are scaled along so they cover the same extent, every pass they lose would have about doubled the measure,
+ * so the thresholds are scaled down by the same gain. 0 selects the full resolution again.
+ * @param index The level to select.
+ */
+void Parameters::selectLevel(int index){
+    int *sizes[3] = {&width, &height, &depth};
+    int *kernels[3] = {&kx, &ky, &kz};
+    int lost = 0;
+
+    scale = 1 << index;
+    for (int d = 0; d < 3; d++) {
+        if (d == 2 && !is4D) continue;  // 3D data has a single z slice
+        *sizes[d] = levelSize[d] / scale;
+        *kernels[d] = std::max(3, (levelKernel[d] - 1) / scale + 1);
+        lost += levelKernel[d] - *kernels[d];
+    }
+    gain = ldexp(1.0f, -lost);
+}
+
+/**
+ * @brief This function estimates the peak memory a single frame of a window costs while it is processed.
+ * Every engine reads its windows from the reader's ring, which holds a window, the new frames of the next one and
+ * mirrors of almost a window, so about 3 bytes per voxel. The ArrayFire engine evaluates one sobel-like operator at a time,
+ * so its peak is the batch, the input and output of a pass, the squared term and the spacetime cube it is added to.
+ * @return long The estimate in bytes.
+ */
+long Parameters::estimateFrameMemory(){
+    const int kernels[3] = {kx, ky, (is4D) ? kz : 1};
+    long voxels = 1;
+    for (int d = 0; d < 3; d++) voxels *= brick[d] + kernels[d] - 1;  // Only one brick is processed at a time
+
+    int passBytes = (isLowPrecision && worstMagnitude() <= SHRT_MAX) ? 2 : 4;
+
+    long ring = 3;
+    if (engine == ENGINE_NATIVE) return voxels * ring;  // the kernel works on tiles of the ring
+    if (isSliding) return voxels * (ring + 1);  // and the uploaded u8 batch, its rings and temporaries do not grow with the window
+
+    long bytes = ring + 1 + ((isLowPrecision) ? 0 : 4);  // uploaded u8 batch and its float conversion
+    bytes += 2 * passBytes + 4 + 4;
+    if (special == 0) bytes += 4;  // mixed terms are doubled in a temporary
+    return voxels * bytes;
+}
+
+/**
+ * @brief This function estimates the memory that stays allocated next to every window, whatever its length.
+ * That is a hull per threshold of a sweep, the native engine also keeps partial hulls of that size per worker.
+ * In sliding mode every group of terms keeps a ring of kt filtered frames, and a time step needs its spacetime,
+ * the value of a term, the weighted frame added to it and the input and output of a spatial pass.
+ * @return long The estimate in bytes.
+ */
+long Parameters::estimateFixedMemory(){
+    long hull = 4L * width * height * depth;
+    long copies = (engine == ENGINE_NATIVE) ? 1 + std::max(1u, std::thread::hardware_concurrency()) : 1;  // Workers of the default pool
+    long bytes = hull * (long) thresholds.size() * copies;
+
+    if (isSliding) {
+        const int kernels[3] = {kx, ky, (is4D) ? kz : 1};
+        long voxels = 1;
+        for (int d = 0; d < 3; d++) voxels *= brick[d] + kernels[d] - 1;
+        bytes += 4L * kt * countSlides() * voxels + 5 * 4L * voxels;
+    }
+    return bytes;
+}
+
+/**
+ * @brief This function counts the groups of terms with distinct spatial orders, like the terms Engine::planTerms lists for the special mode.
+ * @return int The number of rings sliding mode keeps.
+ */
+int Parameters::countSlides(){
+    int spatial = (is4D) ? 3 : 2;
+    if (special == 2) return spatial;  // PdPt2 per spatial dimension
+    if (special == 1) return 1 + spatial;  // Pt2 and Pd2 per spatial dimension
+    return 1 + 2 * spatial + spatial * (spatial - 1) / 2;  // also PdPt per spatial dimension and the mixed spatial pairs
+}
+
+/**
+ * @brief This function bounds the magnitude the sobel-like operators reach on unscaled u8 frames, like the terms Engine::planTerms lists for the special mode.
+ * Frame values are not negative, so a kernel reaches at most 0xFF times the larger of the sums of its positive and of its negative taps.
+ * Every pass only raises that bound, so it also holds for the partially filtered arrays low precision mode keeps.
+ * @return long The bound.
+ */
+long Parameters::worstMagnitude(){
+    const int sizes[4] = {(is4D) ? kz : 1, ky, kx, kt};
+    std::vector<std::vector<int>> orders;  // Derivative orders per dimension (z, y, x, t) of every term
+    for (int d = (is4D) ? 0 : 1; d < 4; d++) {
+        if (special == 0 || special == 1) orders.push_back({d == 0 ? 2 : 0, d == 1 ? 2 : 0, d == 2 ? 2 : 0, d == 3 ? 2 : 0});
+        if (special == 0)
+            for (int e = d + 1; e < 4; e++) orders.push_back({d == 0, d == 1 || e == 1, d == 2 || e == 2, e == 3});
+        if (special == 2 && d < 3) orders.push_back({d == 0, d == 1, d == 2, 2});
+    }
+
+    // The kernels are separable, so the sums of their positive and negative taps follow from those of every dimension
+    double worst = 1;
+    for (const std::vector<int> &order : orders) {
+        double sum = 1, difference = 1;
+        for (int d = 0; d < 4; d++) {
+            std::vector<double> taps = {1};
+            for (int pass = 0; pass < sizes[d] - 1; pass++) {
+                int sign = (pass < sizes[d] - 1 - order[d]) ? 1 : -1;  // Smoothing passes first, like Calc::accumulate
+                taps.push_back(0);
+                for (size_t j = taps.size() - 1; j > 0; j--) taps[j] += sign * taps[j - 1];
+            }
+            double positive = 0, negative = 0;
+            for (double tap : taps) (tap > 0) ? positive += tap : negative -= tap;
+            sum *= positive + negative;
+            difference *= positive - negative;
+        }
+        worst = std::max(worst, (sum + std::fabs(difference)) / 2);
+    }
+    return (long) std::min(worst * 0xFF, (double) LONG_MAX);
+}
+
 /**
  * @brief This function performs misc tests on parameters to check consitences.
  */
 void Parameters::checkParameters(){
-    if (0 >= threshold) printError("Threshold value too small!");
+    isStreamed = !stream.empty();
+    if (isStreamed) checkStream();
+    applyRegion();
+    applyTimeRange();
+    int frames = duration + ((resume.empty()) ? 0 : kt - 1);  // Resumed runs start with the kt - 1 border frames of the state
+    if (thresholds.empty()) thresholds.push_back(threshold);
+    for (int value : thresholds)
+        if (0 >= value) printError("Threshold value too small!");
     if (kx > width) printError("Kernel x size too large!");
     if (kx < 3) printError("Kernel x size too small must be alteast 3!");
     if (ky > height) printError("Kernel y size too large!");
     if (ky < 3) printError("Kernel y size too small must be alteast 3!");
     if (kz > depth && is4D) printError("Kernel z size too large!");
     if (kz < 3 && is4D) printError("Kernel z size too small must be alteast 3!");
-    if (kt > duration) printError("Kernel t size too large!");
+    if (kt > frames && !isStreamed) printError("Kernel t size too large!");
     if (kt < 3) printError("Kernel t size too small must be alteast 3!");
 
+#ifndef BP_ARRAYFIRE
+    if (isViewed) printError("Grayscale view needs a build with ArrayFire!");
+#endif
     if (!isViewed && viewSlice != -1) printError("View slice given but grayscale off!");
     if (isViewed && viewSlice == -1 && is4D) printError("4D date viewed without view slice!");
     if (isViewed && viewSlice != -1 && !is4D) printError("View slice given for 3D data!");
     if (isViewed && is4D && !(0 <= viewSlice && viewSlice <= depth - kz + 1)) printError("Invalid view slice size!");
 
-    if (0 >= batches) printError("Too little batches must be atleast 1!");
-    if (batches > duration - kt + 1) printError("Too many batches!");
+    planBricks();
+    if (memoryBudget < 0) printError("Memory budget can not be negative!");
+    if (memoryBudget && window == DEFAULT_WINDOW) {
+        long available = ((long) memoryBudget << 20) - estimateFixedMemory();
+        window = (int) std::min(available / estimateFrameMemory(), (long) INT_MAX);
+        if (window < kt) printError("Memory budget too small to hold the kernel t size!");
+    }
+    if (isStreamed && window == DEFAULT_WINDOW) window = STREAM_WINDOW_FACTOR * kt;
+    if (window == DEFAULT_WINDOW) {
+        if (0 >= batches) printError("Too little batches must be atleast 1!");
+        if (batches > frames - kt + 1) printError("Too many batches!");
+        window = (frames + (batches - 1) * (kt - 1) + batches - 1) / batches;
+    }
+    if (window < kt) printError("Window too small must be atleast the kernel t size!");
+    if (window > frames && !isStreamed) window = frames;
+    batches = (isStreamed) ? 0 : (frames - kt + 1 + window - kt) / (window - kt + 1);  // Number of windows needed to cover the data
+    if (bricks > 1 && !(saveState.empty() && resume.empty())) printError("States are not available for bricks!");
+    if (thresholds.size() > 1 && bricks > 1) printError("Threshold sweeps are not available for bricks!");
+    if (thresholds.size() > 1 && (isSharded || !saveState.empty() || !resume.empty())) printError("States are not available for threshold sweeps!");
 
     if (special != 0 && special != 1 && special != 2) printError("Invalid special value");
+    if (isSliding && engine == ENGINE_NATIVE) printError("Sliding mode is for the ArrayFire engine, the native engine already works a block of time steps at a time!");
+    if (cacheSize < 0) printError("Cache size can not be negative!");
+    if (snapshotEvery < 0) printError("Snapshot cadence can not be negative!");
+    planLevels();
 }
 
 /**
@@ -113,6 +494,7 @@ void Parameters::printHelp(){
     cout << "\tThe dimension file's first line should contain 3 ints denoting the size of Spatio images." << endl;
     cout << "\tThe next line in the file should be the number of n frames in the Spatio-Temporal data." << endl;
     cout << "\tThe last n lines should be the directory of the n images." << endl;
+    cout << "\tAlternatively DIMENSION-FILE can be a container holding all frames (see convert)." << endl;
 
     cout << "OPTIONS are:" << endl;
     cout << "\t-h,  --help \t\tDisplays this menu" << endl;
@@ -120,13 +502,29 @@ void Parameters::printHelp(){
     cout << "\t-gs, --gray-scale \tWhen this option is on a grayscale of the hulls is displayed" << endl;
     cout << "\t     --view-slice \tThe integer following this option gives the z slice to display in grayscale of 3D hulls" << endl;
     cout << "\t-b,  --batches \t\tThe integer value following this option gives the number of batches (DEFAULT=" << DEFAULT_BATCHES << ")" << endl;
-    cout << "\t-th, --threshold \tThe integer following this option gives the threshold used in hull computation (DEFAULT=" << DEFAULT_THRESHOLD << ")" << endl;
+    cout << "\t-w,  --window \t\tThe integer following this option gives the number of frames kept in memory at once, overrides --batches" << endl;
+    cout << "\t-th, --threshold \tThe integer following this option gives the threshold used in hull computation, a comma separated list sweeps several in one pass (DEFAULT=" << DEFAULT_THRESHOLD << ")" << endl;
     cout << "\t-kx, --kernel-x-size \tThe integer following this option gives the kernel x size used in hull computation (DEFAULT=" << DEFAULT_KERNEL_SIZE_X << ")" << endl;
     cout << "\t-ky, --kernel-y-size \tThe integer following this option gives the kernel y size used in hull computation (DEFAULT=" << DEFAULT_KERNEL_SIZE_Y << ")" << endl;
     cout << "\t-kz, --kernel-z-size \tThe integer following this option gives the kernel z size used in hull computation (DEFAULT=" << DEFAULT_KERNEL_SIZE_Z << ")" << endl;
     cout << "\t-kt, --kernel-t-size \tThe integer following this option gives the kernel t size used in hull computation (DEFAULT=" << DEFAULT_KERNEL_SIZE_T << ")" << endl;
     cout << "\t-ea, --export-animation\tWhen this option is on the animation is exported with the hulls in .obj files" << endl;
     cout << "\t-s,  --special \t\tThe following number in range [0-2] gives different ways of computing the hulls (DEFAULT=" << DEFAULT_SPECIAL << ")" << endl;
+    cout << "\t-lp, --low-precision \tWhen this option is on batches stay 8 bit and the filters use integer arithmetic, to fit more frames in memory" << endl;
+    cout << "\t     --sliding \t\tWhen this option is on every frame is filtered spatially once and only the last kt are kept, so memory does not grow with the window" << endl;
+    cout << "\t     --box-filter \tWhen this option is on kernels of size " << BOX_MIN_SIZE << " and up are approximated by running sums, so their cost does not grow with the size but the hulls are approximate too" << endl;
+    cout << "\t     --roi-x \t\tThe range a:b following this option limits the hulls to x in [a, b), likewise --roi-y, --roi-z and --roi-t" << endl;
+    cout << "\t     --stream \t\tThe path following this option is a Unix socket (or - for stdin) to read raw frames from instead of files" << endl;
+    cout << "\t     --snapshot-every \tThe integer following this option gives after how many frames the hulls so far are written (DEFAULT=" << DEFAULT_SNAPSHOT_EVERY << ")" << endl;
+    cout << "\t     --time-range \tThe range a:b following this option only computes the time steps in [a, b) and saves them as partial hulls (see merge), a:  runs to the last time step" << endl;
+    cout << "\t     --save-state \tThe path following this option is where the state to resume from is saved after the run" << endl;
+    cout << "\t     --resume \t\tThe path following this option is a saved state, the hulls are then updated with only the new frames given" << endl;
+    cout << "\t     --brick \t\tThe sizes x,y,z following this option split the hulls into bricks computed one at a time, to fit large volumes in memory" << endl;
+    cout << "\t     --pyramid \t\tThe integer N following this option first computes preview hulls at N levels of halved resolution, written to hulls_L<N>.obj" << endl;
+    cout << "\t     --level \t\tThe integer L following this option only computes the hulls at 1/2^L resolution, with kernel sizes scaled to match" << endl;
+    cout << "\t-e,  --engine \t\tThe name following this option is the engine computing the hulls: af or native (DEFAULT=" << ((DEFAULT_ENGINE == ENGINE_NATIVE) ? "native" : "af") << ")" << endl;
+    cout << "\t-mb, --memory-budget \tThe integer following this option gives the MB of device memory to size windows by, overrides --batches" << endl;
+    cout << "\t-cs, --cache-size \tThe integer following this option gives the MB of frames cached for reuse, 0 disables it (DEFAULT=" << DEFAULT_CACHE_SIZE << ")" << endl;
 }
 
 /**
@@ -145,9 +543,16 @@ void Parameters::printError(const char *error){
  * @param argv Array of program arguments.
  */
 Parameters::Parameters(int argc, char *argv[])
-:isViewed(DEFAULT_GRAYSCALE),viewSlice(DEFAULT_VIEW_SLICE),isTimed(DEFAULT_TIMER),batches(DEFAULT_BATCHES),
+:isViewed(DEFAULT_GRAYSCALE),viewSlice(DEFAULT_VIEW_SLICE),isTimed(DEFAULT_TIMER),batches(DEFAULT_BATCHES),window(DEFAULT_WINDOW),
 kx(DEFAULT_KERNEL_SIZE_X),ky(DEFAULT_KERNEL_SIZE_Y),kz(DEFAULT_KERNEL_SIZE_Z),kt(DEFAULT_KERNEL_SIZE_Z),threshold(DEFAULT_THRESHOLD)
-,exportAnimation(DEFAULT_EXPORT_ANIMATION),special(DEFAULT_SPECIAL){
+,special(DEFAULT_SPECIAL),isLowPrecision(DEFAULT_LOW_PRECISION),isSliding(DEFAULT_SLIDING),isBoxFiltered(DEFAULT_BOX_FILTERED),exportAnimation(DEFAULT_EXPORT_ANIMATION),cacheSize(DEFAULT_CACHE_SIZE),snapshotEvery(DEFAULT_SNAPSHOT_EVERY),memoryBudget(DEFAULT_MEMORY_BUDGET),engine(DEFAULT_ENGINE),
+pyramid(DEFAULT_PYRAMID),level(DEFAULT_LEVEL),scale(1),gain(1){
+    for (int d = 0; d < 4; d++)
+        roi[d][0] = roi[d][1] = -1;
+    for (int d = 0; d < 3; d++)
+        brick[d] = 0;
+    timeRange[0] = timeRange[1] = -1;
+
     if (argc == 1)  // No file guard
         printError("No file given!");
 
@@ -167,5 +572,5 @@ kx(DEFAULT_KERNEL_SIZE_X),ky(DEFAULT_KERNEL_SIZE_Y),kz(DEFAULT_KERNEL_SIZE_Z),kt
  */
 Parameters::~Parameters(){
     file.close();
-    free(datafiles);
+    delete [] datafiles;
 }
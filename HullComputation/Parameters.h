@@ -13,13 +13,35 @@
 #include <iostream>
 #include <cstring>
 #include <sstream>
+#include <vector>
+
+#include "Container.h"
+
+#define ENGINE_ARRAYFIRE 0
+#define ENGINE_NATIVE 1
+// In box filter mode smaller kernels stay exact, the running sums only beat the binomial passes from about this size.
+// The boxes approximate the binomial weights, so hulls drift from the exact ones as the size grows:
+// on benchmark_box about 90% of the voxels agree on being in the hull at size 19 and 79% at size 31
+#define BOX_MIN_SIZE 19
 
 namespace HullComputation{
     class Parameters {
     private:
         std::ifstream file;
+        int regionOffset[3], regionSize[3], levelSize[3], levelKernel[3];
         void parseFile(std::string filepath);
         void parseOptions(int n, char **options);
+        int parseEngine(std::string name);
+        void parseThresholds(std::string list);
+        void parseTimeRange(std::string range);
+        void checkStream();
+        void applyRegion();
+        void applyTimeRange();
+        void planBricks();
+        void planLevels();
+        long estimateFrameMemory();
+        long estimateFixedMemory();
+        int countSlides();
         void checkParameters();
         void printHelp();
         void printError(const char *error);
@@ -28,11 +50,24 @@ namespace HullComputation{
         Parameters(int argc, char *argv[]);
         ~Parameters();
         int isViewed, viewSlice;
-        int isTimed, batches;
-        int kx, ky, kz, kt, threshold, special;
+        int isTimed, batches, window;
+        int kx, ky, kz, kt, threshold, special, isLowPrecision, isSliding, isBoxFiltered;
         int width, height, depth, duration, is4D;
-        int exportAnimation;
+        int roi[4][2], offsetX, offsetY, offsetZ, offsetT;
+        int fullWidth, fullHeight, fullDepth, fullDuration;
+        int exportAnimation, cacheSize;
+        std::vector<int> thresholds;
         std::string *datafiles;
+        std::string container, stream, saveState, resume;
+        int timeRange[2], firstStep, isSharded;
+        int isStreamed, snapshotEvery;
+        int memoryBudget, engine;
+        int brick[3], bricks, brickX, brickY, brickZ;
+        int pyramid, level, scale;
+        float gain;
+        void selectBrick(int index);
+        void selectLevel(int index);
+        long worstMagnitude();
     };
 }
 
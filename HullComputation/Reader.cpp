@@ -6,56 +6,396 @@
  * @version 1.0
  */
 #include "Reader.h"
+#include "Codec.h"
+#include "ThreadPool.h"
+#include "FrameCache.h"
+
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace HullComputation;
-using namespace std;
+#ifdef BP_ARRAYFIRE
 using namespace af;
+#endif
+using std::string;
+using std::cerr;
+using std::endl;
+namespace chrono = std::chrono;
 
 /**
- * @brief This function reads datafiles and returns them as 2 or 3D arrays.
- * @param filename The path to the data file as a string.
- * @return array An arrayfire array containing the data.
+ * @brief This function reads a single frame of the region of interest.
+ * @param frame The index of the frame.
+ * @param destination Where to copy the frame to.
  */
-array Reader::readFile(string filename) {
-    int n = params->height * params->width * params->depth; 
-    char *data = new char[n];
-
-    ifstream datafile;
-    datafile.open(filename);
-    if (!datafile) {
-        cerr << "file: " << filename << " not found!" << endl;
+void Reader::getFrame(int frame, unsigned char *destination) {
+    if (!readFrame(frame, destination)) {
+        cerr << "frame: " << frame << " not found!" << endl;
         exit(EXIT_FAILURE);
     }
-    datafile.read(data, n);
+}
+
+/**
+ * @brief This function gives the position of a frame in the ring.
+ * Preloaded frames come before the time series, so frame -1 is the last of them.
+ * @param frame The index of the frame in the time series.
+ * @return unsigned char* Pointer to the slot of the frame.
+ */
+unsigned char *Reader::slot(int frame){
+    return ring + (long) ((frame + start) % capacity) * frameSize;
+}
+
+/**
+ * @brief This function copies a frame after the end of the ring if it is in one of its first slots, so that any window is contiguous.
+ * @param frame The index of the frame in the time series.
+ */
+void Reader::mirror(int frame){
+    int position = (frame + start) % capacity;
+    if (position < mirrored) memcpy(ring + (long) (capacity + position) * frameSize, slot(frame), frameSize);
+}
+
+/**
+ * @brief This function copies the region of interest out of a full frame.
+ * Depth is the contiguous dimension, so whole columns are copied at once when the region spans the full depth.
+ * @param full The full frame.
+ * @param destination Where to copy the region to.
+ */
+void Reader::crop(const unsigned char *full, unsigned char *destination){
+    if (params->scale > 1) {
+        shrink(full, destination);
+        return;
+    }
+    if (frameSize == fullSize) {
+        memcpy(destination, full, frameSize);
+        return;
+    }
+
+    int w = params->width, h = params->height, d = params->depth;
+    long fh = params->fullHeight, fd = params->fullDepth;
+    for (int x = 0; x < w; x++) {
+        const unsigned char *column = full + params->offsetZ + fd * (params->offsetY + fh * (params->offsetX + x));
+        if (d == fd) memcpy(destination + (long) d * h * x, column, (long) d * h);
+        else for (int y = 0; y < h; y++)
+            memcpy(destination + d * (y + (long) h * x), column + fd * y, d);
+    }
+}
+
+/**
+ * @brief This function copies the region of interest out of a full frame at the resolution of a pyramid level.
+ * Every voxel is the mean of the block of the region it covers, scale^3 voxels large or scale^2 for 3D data.
+ * @param full The full frame.
+ * @param destination Where to copy the downsampled region to.
+ */
+void Reader::shrink(const unsigned char *full, unsigned char *destination){
+    int w = params->width, h = params->height, d = params->depth, s = params->scale;
+    int sz = (params->is4D) ? s : 1, count = s * s * sz;
+    long fh = params->fullHeight, fd = params->fullDepth;
+    std::vector<int> sums(d);
+
+    for (int x = 0; x < w; x++)
+        for (int y = 0; y < h; y++) {
+            std::fill(sums.begin(), sums.end(), 0);
+            for (int i = 0; i < s; i++)
+                for (int j = 0; j < s; j++) {
+                    const unsigned char *column = full + params->offsetZ + fd * (params->offsetY + y * s + j + fh * (params->offsetX + x * s + i));
+                    for (int z = 0; z < d * sz; z++) sums[z / sz] += column[z];
+                }
+            unsigned char *target = destination + d * (y + (long) h * x);
+            for (int z = 0; z < d; z++) target[z] = (sums[z] + count / 2) / count;
+        }
+}
+
+/**
+ * @brief This helper function reads a range of a file, retrying on short reads.
+ * @param file The file descriptor.
+ * @param destination Where to read to.
+ * @param size The number of bytes to read.
+ * @param offset The offset in the file.
+ */
+static void readAt(int file, unsigned char *destination, long size, long offset){
+    while (size > 0) {
+        ssize_t n = pread(file, destination, size, offset);
+        if (n <= 0) {
+            cerr << "[Reader Error]: \tUnexpected end of frame file!" << endl;
+            exit(EXIT_FAILURE);
+        }
+        destination += n;
+        size -= n;
+        offset += n;
+    }
+}
+
+/**
+ * @brief This function reads the region of interest of a raw container frame or a frame file, with one read per x column.
+ * @param source The index of the frame in the container.
+ * @param file The file descriptor of the frame file, or -1 to read from the container.
+ * @param destination Where to read the region to.
+ */
+void Reader::readRegion(int source, int file, unsigned char *destination){
+    int w = params->width, h = params->height, d = params->depth;
+    long fh = params->fullHeight, fd = params->fullDepth, span = fd * (h - 1) + d;
+    std::vector<unsigned char> column(span);
+
+    for (int x = 0; x < w; x++) {
+        long start = params->offsetZ + fd * (params->offsetY + fh * (params->offsetX + x));
+        unsigned char *target = (d == fd) ? destination + (long) d * h * x : column.data();  // Full depth columns are contiguous in the frame
+        if (file >= 0) readAt(file, target, span, start);
+        else if (!container->readFrameRange(source, start, span, target)) {
+            cerr << "[Reader Error]: \tFrame " << source << " could not be read from the container!" << endl;
+            exit(EXIT_FAILURE);
+        }
+        if (d == fd) continue;
+        for (int y = 0; y < h; y++)
+            memcpy(destination + d * (y + (long) h * x), column.data() + fd * y, d);
+    }
+}
+
+/**
+ * @brief This function reads the region of interest of a frame from its own file.
+ * Whole frames are read straight into the destination, mapping them would only add a copy and an mmap and munmap per frame.
+ * Regions at full resolution are read a column at a time, downsampled regions are mapped with only the span of the region hinted,
+ * so in both cases the cost is that of the region rather than of the whole frame.
+ * @param source The index of the frame in the time series.
+ * @param destination Where to copy the region to.
+ * @return true Once the frame is read.
+ */
+bool Reader::readFile(int source, unsigned char *destination){
+    const string &path = params->datafiles[source];
+    if (params->scale == 1) {
+        int file = open(path.c_str(), O_RDONLY);
+        struct stat info;
+        if (file < 0 || fstat(file, &info) < 0 || info.st_size < fullSize) {
+            cerr << "file: " << path << " not found or too small, expected " << fullSize << " bytes!" << endl;
+            exit(EXIT_FAILURE);
+        }
+        if (frameSize == fullSize) readAt(file, destination, frameSize, 0);
+        else {
+            posix_fadvise(file, 0, 0, POSIX_FADV_RANDOM);  // Read ahead would fetch the voxels between the columns
+            readRegion(source, file, destination);
+        }
+        close(file);
+        return true;
+    }
 
-    datafile.close();
-    array dataMatrix = array(1, params->depth, params->height, params->width, (unsigned char *) data);
-    delete [] data;
-    return dataMatrix;
+    // The region covers scale times its size at full resolution, from its first column to the end of its last
+    int s = params->scale, sz = (params->is4D) ? s : 1;
+    long fh = params->fullHeight, fd = params->fullDepth;
+    long first = params->offsetZ + fd * (params->offsetY + fh * params->offsetX);
+    long last = params->offsetZ + fd * (params->offsetY + fh * (params->offsetX + (long) params->width * s - 1));
+    MappedFile file(path, fullSize, first, last + fd * ((long) params->height * s - 1) + (long) params->depth * sz - first);
+    shrink(file.bytes(), destination);
+    return true;
 }
 
 /**
- * @brief This function returns the next batch of Spatio-Temporal data to process.
- * @return array An arrayfire array containing the data.
+ * @brief This function blocks until the next frame of the stream arrives, streamed frames are not cached
+ * as they can only be read once.
+ * @param destination Where to copy the region of interest of the frame to.
+ * @return true If the frame was read, false if the stream ended.
  */
-array Reader::getNextBatch(){
-    if (batchNum != 0) {  // Case not first batch
-        int border = params->kt - 1;    
-        int tSize = (params->duration + (params->batches - 1) * border + batchNum) / params->batches;
-        array nextBatch = array(tSize, params->depth, params->height, params->width);
+bool Reader::readStreamed(unsigned char *destination){
+    if (frameSize == fullSize) return stream->read(destination, frameSize);
 
-        // Copy shared border
-        nextBatch(seq(border), span, span, span) = batch(seq(border * -1, -1), span, span, span);
-        batch = nextBatch;
+    std::vector<unsigned char> full(fullSize);
+    if (!stream->read(full.data(), fullSize)) return false;
+    crop(full.data(), destination);
+    return true;
+}
+
+/**
+ * @brief This function reads a frame of the region of interest, from the frame cache if possible.
+ * Otherwise it is read from the container if there is one or else from its own file, and then cached.
+ * @param frame The index of the frame in the time series.
+ * @param destination Where to copy the frame to.
+ * @return true If the frame was read, false if the time series has ended.
+ */
+bool Reader::readFrame(int frame, unsigned char *destination){
+    if (stream) return readStreamed(destination);
+    if (frame >= params->duration) return false;
+    if (FrameCache::shared().lookup(frame, destination, frameSize)) return true;
 
-        for (int i = border; i < tSize; i++)
-            batch(i, span, span, span) = readFile(params->datafiles[pointer++]);
+    int source = frame + params->offsetT;
+    if (container && container->getEncoding() == CONTAINER_ENCODING_RAW && params->scale == 1) {
+        readRegion(source, -1, destination);
+    } else if (container) {
+        std::vector<unsigned char> full(fullSize);
+        if (!container->readFrame(source, full.data())) {
+            cerr << "[Reader Error]: \tFrame " << source << " could not be read from the container!" << endl;
+            exit(EXIT_FAILURE);
+        }
+        crop(full.data(), destination);
+    } else {
+        readFile(source, destination);
     }
 
-    batchNum++;
-    return batch / 0xFF;
+    FrameCache::shared().insert(frame, destination, frameSize);
+    return true;
 }
 
+/**
+ * @brief This function decodes the next frames of an encoded container into the ring.
+ * Payloads are decoded into residuals on the thread pool a chunk at a time, after which the full frames are rebuilt
+ * in order and cropped into the ring. If the previous frame was not decoded, decoding starts at its key frame.
+ * @param count The number of frames to decode.
+ */
+void Reader::decodeWindow(int count){
+    int cached = 1;
+    for (int f = next; f < next + count && cached; f++)
+        cached = FrameCache::shared().lookup(f, slot(f), frameSize);
+
+    int first = next + params->offsetT, last = first + count, chunk = pool->size();
+    int key = container->getKeyFrame(first);
+    int start = (decodedFrame >= key && decodedFrame < first) ? decodedFrame + 1 : key;
+
+    for (int s = start; s < last && !cached; s += chunk) {
+        int n = std::min(chunk, last - s);
+        for (int i = 0; i < n; i++)
+            pool->submit([this, s, i]() {
+                std::vector<unsigned char> payload(container->getPayloadSize(s + i));
+                container->readPayload(s + i, payload.data());
+                Codec::decode(payload.data(), payload.size(), residuals + i * fullSize, fullSize);
+            });
+        pool->wait();
+
+        for (int i = 0; i < n; i++) {
+            if (container->isKeyFrame(s + i)) memcpy(decoded, residuals + i * fullSize, fullSize);
+            else Codec::apply(residuals + i * fullSize, decoded, fullSize);
+            decodedFrame = s + i;
+
+            int f = s + i - params->offsetT;
+            if (decodedFrame < first) continue;
+            crop(decoded, slot(f));
+            FrameCache::shared().insert(f, slot(f), frameSize);
+        }
+    }
+
+    for (int f = next; f < next + count; f++) mirror(f);
+}
+
+/**
+ * @brief This function fills the ring with the frames of the next window, it is run on a background thread.
+ * Only the frames that are new to the window are read, the kt - 1 border frames stay in their slot,
+ * and so do frames loaded for a window that was shrunk before it was handed out.
+ */
+void Reader::loadWindow(){
+    chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+    int length = window;
+    int needed = ((next + start == 0) ? length : length - border) - loaded;
+
+    if (pool) {  // Encoded frames are decoded in parallel
+        int count = std::max(0, std::min(needed, params->duration - next));
+        decodeWindow(count);
+        next += count;
+        loaded += count;
+    } else {
+        for (int n = 0; n < needed && readFrame(next, slot(next)); n++, next++, loaded++) mirror(next);
+    }
+
+    prefetchTime = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - begin).count();
+}
+
+/**
+ * @brief This function checks whether there is another window of data to process, waiting for it to be loaded if needed.
+ * @return true If getNextBatch can be called, false if the time series has been consumed.
+ */
+bool Reader::hasNextBatch(){
+    if (!ring) {  // The ring is only allocated once batches are requested
+        ring = new unsigned char[(capacity + mirrored) * frameSize];
+        if (pool) {
+            decoded = new unsigned char[fullSize];
+            residuals = new unsigned char[pool->size() * fullSize];
+        }
+        for (int f = -start; f < 0; f++) {
+            memcpy(slot(f), preloaded.data() + (f + start) * frameSize, frameSize);
+            mirror(f);
+        }
+        prefetch = std::async(std::launch::async, &Reader::loadWindow, this);
+    }
+
+    if (prefetch.valid()) {
+        chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+        prefetch.get();
+        waitTime = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - begin).count();
+        loadTime = prefetchTime;
+    }
+
+    // A stream can end before the first window holds a full temporal kernel
+    int length = (next + start == loaded) ? loaded : border + loaded;
+    return loaded > 0 && length >= params->kt;
+}
+
+/**
+ * @brief This function gives the next window of Spatio-Temporal data to process, and starts prefetching the one after.
+ * The window is laid out frame after frame, so time is the last dimension. It stays in the ring, the frames of the next
+ * window are loaded into other slots, so it can be read until the next call to hasNextBatch.
+ * A window shrunk by setWindow is handed out at its new length, the frames loaded past it are kept for the next window.
+ * @param frames Set to the first frame of the window.
+ * @return int The number of frames in the window.
+ */
+int Reader::getNextBatch(const unsigned char *&frames){
+    int isFirst = (next + start == loaded);
+    int fresh = std::min((int) loaded, (isFirst) ? (int) window : window - border);
+    int length = (isFirst) ? fresh : border + fresh;
+    frames = slot(next - loaded + fresh - length);
+
+    loaded -= fresh;
+    prefetch = std::async(std::launch::async, &Reader::loadWindow, this);
+    return length;
+}
+
+/**
+ * @brief This function places frames before the time series, such as the border frames of a previous run, it has to be called before any batch is read.
+ * @param frames The frames, laid out frame after frame.
+ * @param count The number of frames.
+ */
+void Reader::preload(const unsigned char *frames, int count){
+    preloaded.assign(frames, frames + count * frameSize);
+    start = count;
+}
+
+/**
+ * @brief This function copies out the kt - 1 frames the next window would have started with, after the last batch was read.
+ * @param destination Where to copy the frames to, laid out frame after frame.
+ */
+void Reader::getBorder(unsigned char *destination){
+    memcpy(destination, slot(next - border), border * frameSize);
+}
+
+/**
+ * @brief Getter for the number of frames per window.
+ * @return int The window length.
+ */
+int Reader::getWindow(){
+    return window;
+}
+
+/**
+ * @brief This function changes the number of frames per window, the ring is not reallocated so it can only shrink.
+ * The new length is used from the next window on, even when it is already being prefetched.
+ * @param length The new window length, clamped to [kt, params->window].
+ */
+void Reader::setWindow(int length){
+    window = std::max(params->kt, std::min(length, params->window));
+}
+
+/**
+ * @brief Getter for the time it took to load the last window from disk.
+ * @return long The load time in microseconds.
+ */
+long Reader::getLoadTime(){
+    return loadTime;
+}
+
+/**
+ * @brief Getter for the time spent waiting for the last window to finish loading.
+ * @return long The wait time in microseconds.
+ */
+long Reader::getWaitTime(){
+    return waitTime;
+}
+
+#ifdef BP_ARRAYFIRE
 /**
  * @brief This function returns an 3D array representing data as an animation for display purposes.
  * @return array Arrayfire array of animation.
@@ -63,9 +403,11 @@ array Reader::getNextBatch(){
 array Reader::getAnimation() {
     int h = params->height, w = params->width, frames = params->duration;
     array animation = array(h, w, frames, dtype::u8);
+    std::vector<unsigned char> data(frameSize);
 
     for (int t = 0; t < frames; t++) {
-        array frame = readFile(params->datafiles[t]);
+        getFrame(t, data.data());
+        array frame = array(1, params->depth, params->height, params->width, data.data());
         int i = (params->is4D) ? params->viewSlice + params->kz / 2 - 1 : 0;
         animation(span, span, t) = flip(reorder(frame(span, i, span, span), 2, 3, 0, 1), 0);
 
@@ -73,17 +415,36 @@ array Reader::getAnimation() {
 
     return animation;
 }
+#endif
 
 /**
- * @brief Construct a new Reader:: Reader object, it also prepares the first batch of data.
+ * @brief Construct a new Reader:: Reader object.
  * @param params The parameters to use.
  */
 Reader::Reader(Parameters *params)
-:params(params),batchNum(0),pointer(0){
-    // Read the first batch
-    int border = params->kt - 1;    
-    int tSize = (params->duration + (params->batches - 1) * border) / params->batches;
-    batch = array(tSize, params->depth, params->height, params->width);
-    for (int i = 0; i < tSize; i++)
-        batch(i, span, span, span) = readFile(params->datafiles[pointer++]);
+:params(params),ring(nullptr),decoded(nullptr),residuals(nullptr),decodedFrame(-1),capacity(2 * params->window - params->kt + 1),mirrored(params->window - 1),border(params->kt - 1),next(0),loaded(0),start(0),window(params->window),
+prefetchTime(0),loadTime(0),waitTime(0){
+    frameSize = (long) params->height * params->width * params->depth;
+    fullSize = (long) params->fullHeight * params->fullWidth * params->fullDepth;
+    container = (params->container.empty()) ? nullptr : new Container(params->container);
+    if (container && (container->getWidth() != params->fullWidth || container->getHeight() != params->fullHeight
+                      || container->getDepth() != params->fullDepth || container->getFrames() != params->fullDuration)) {
+        cerr << "[Reader Error]: \tContainer does not match the dimensions!" << endl;
+        exit(EXIT_FAILURE);
+    }
+    stream = (params->isStreamed) ? new Stream(params->stream) : nullptr;
+    pool = (container && container->getEncoding() != CONTAINER_ENCODING_RAW) ? new ThreadPool() : nullptr;
+}
+
+/**
+ * @brief Destroy the Reader:: Reader object, waits for any pending prefetch.
+ */
+Reader::~Reader(){
+    if (prefetch.valid()) prefetch.wait();
+    delete [] ring;
+    delete [] decoded;
+    delete [] residuals;
+    delete pool;
+    delete container;
+    delete stream;
 }
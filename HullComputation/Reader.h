@@ -9,24 +9,65 @@
 #ifndef BP_READER_H
 #define BP_READER_H
 
+#ifdef BP_ARRAYFIRE
 #include <arrayfire.h>
+#endif
 #include "Parameters.h"
+#include "MappedFile.h"
+#include "Container.h"
+#include "Stream.h"
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <cstring>
+#include <future>
+#include <chrono>
+#include <atomic>
+#include <vector>
 
 namespace HullComputation{
+    class ThreadPool;
+
     class Reader {
     private:
         Parameters *params;
-        af::array batch;
-        int batchNum, pointer;
+        Container *container;
+        Stream *stream;
+        ThreadPool *pool;
+        unsigned char *ring, *decoded, *residuals;
+        long frameSize, fullSize;
+        int decodedFrame;
+        int capacity, mirrored, border, next, loaded, start;  // The ring holds a window and the new frames of the next one
+        std::vector<unsigned char> preloaded;
+        std::atomic<int> window;
+        std::future<void> prefetch;
+        long prefetchTime, loadTime, waitTime;
+        unsigned char *slot(int frame);
+        void mirror(int frame);
+        void crop(const unsigned char *full, unsigned char *destination);
+        void shrink(const unsigned char *full, unsigned char *destination);
+        void readRegion(int source, int file, unsigned char *destination);
+        bool readFile(int source, unsigned char *destination);
+        bool readStreamed(unsigned char *destination);
+        bool readFrame(int frame, unsigned char *destination);
+        void decodeWindow(int count);
+        void loadWindow();
 
     public:
         Reader(Parameters *params);
-        af::array readFile(std::string file);
-        af::array getNextBatch();
+        ~Reader();
+        void getFrame(int frame, unsigned char *destination);
+        bool hasNextBatch();
+        int getNextBatch(const unsigned char *&frames);
+#ifdef BP_ARRAYFIRE
         af::array getAnimation();
+#endif
+        void preload(const unsigned char *frames, int count);
+        void getBorder(unsigned char *destination);
+        int getWindow();
+        void setWindow(int length);
+        long getLoadTime();
+        long getWaitTime();
     };    
 }
 
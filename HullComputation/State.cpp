@@ -0,0 +1,108 @@
+/**
+ * @file State.cpp
+ * @author Antonin Thioux (antonin.thioux@gmail.com)
+ * @brief This file contains the logic for saving and resuming the state of a hull computation.
+ * @date last modified at 2026-10-16
+ * @version 1.0
+ */
+
+#include "State.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using namespace HullComputation;
+using namespace std;
+
+/**
+ * @brief This function displays a state error and exits.
+ * @param error The error message to display.
+ */
+void State::printError(const char *error){
+    cerr << "[State Error]: \t" << error << endl;
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Construct a new State object, sized for the region and kernels of the parameters.
+ * @param params The Parameters object.
+ */
+State::State(Parameters *params):params(params),t(1 + params->firstStep),first(params->firstStep),last(params->firstStep){
+    long frameSize = (long) params->width * params->height * params->depth;
+    long hullSize = (long) ((params->is4D) ? params->depth - params->kz + 1 : 1) * (params->height - params->ky + 1) * (params->width - params->kx + 1);
+    border.resize((params->kt - 1) * frameSize);
+    labels.resize(hullSize);
+}
+
+/**
+ * @brief This function reads a state, it has to have been saved with the same region, resolution, kernels, special mode, threshold,
+ * precision and engine.
+ * @param filename The path to the state file.
+ */
+void State::read(string filename){
+    ifstream file(filename, ios::binary);
+    if (!file) printError("State file not found!");
+
+    StateHeader header;
+    file.read((char *) &header, sizeof(header));
+    if (!file || memcmp(header.magic, STATE_MAGIC, 7)) printError("Not a state file!");
+    if (memcmp(header.magic, STATE_MAGIC, sizeof(header.magic))) printError("State was saved by another version!");
+    if ((int) header.width != params->width || (int) header.height != params->height || (int) header.depth != params->depth)
+        printError("State was saved for other dimensions!");
+    if ((int) header.offsetX != params->offsetX || (int) header.offsetY != params->offsetY || (int) header.offsetZ != params->offsetZ)
+        printError("State was saved for another region of interest!");
+    if ((int) header.scale != params->scale) printError("State was saved for another pyramid level!");
+    if ((int) header.kx != params->kx || (int) header.ky != params->ky || (int) header.kz != params->kz || (int) header.kt != params->kt)
+        printError("State was saved for other kernel sizes!");
+    if ((int) header.special != params->special || (int) header.threshold != params->threshold)
+        printError("State was saved for another special mode or threshold!");
+    if ((int) header.lowPrecision != params->isLowPrecision || (int) header.engine != params->engine)
+        printError("State was saved for another precision or engine!");
+
+    t = header.t;
+    first = header.first;
+    last = header.last;
+    file.read((char *) border.data(), border.size());
+    file.read((char *) labels.data(), labels.size() * sizeof(float));
+    if (!file) printError("Unexpected end of state file!");
+}
+
+/**
+ * @brief This function writes the state, through a temporary file so an interrupted run never leaves a broken state behind.
+ * @param filename The path to the state file.
+ */
+void State::write(string filename){
+    StateHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, STATE_MAGIC, sizeof(header.magic));
+    header.width = params->width;
+    header.height = params->height;
+    header.depth = params->depth;
+    header.kx = params->kx;
+    header.ky = params->ky;
+    header.kz = params->kz;
+    header.kt = params->kt;
+    header.special = params->special;
+    header.threshold = params->threshold;
+    header.t = t;
+    header.first = first;
+    header.last = t - 1;  // Time step s is labelled s + 1
+    header.offsetX = params->offsetX;
+    header.offsetY = params->offsetY;
+    header.offsetZ = params->offsetZ;
+    header.scale = params->scale;
+    header.lowPrecision = params->isLowPrecision;
+    header.engine = params->engine;
+
+    string temporary = filename + ".tmp";
+    {
+        ofstream file(temporary, ios::binary | ios::trunc);
+        file.write((const char *) &header, sizeof(header));
+        file.write((const char *) border.data(), border.size());
+        file.write((const char *) labels.data(), labels.size() * sizeof(float));
+        if (!file) printError("Could not write state file!");
+    }
+    if (rename(temporary.c_str(), filename.c_str())) printError("Could not replace state file!");
+}
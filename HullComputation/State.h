@@ -0,0 +1,50 @@
+/**
+ * @file State.h
+ * @author Antonin Thioux (antonin.thioux@gmail.com)
+ * @brief Header file of State.cpp
+ * @date last modified at 2026-10-16
+ * @version 1.0
+ */
+
+#ifndef BP_STATE_H
+#define BP_STATE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Parameters.h"
+
+#define STATE_MAGIC "STSTATE2"
+
+namespace HullComputation {
+    /**
+     * @brief The header at the start of a state file, it is followed by the border frames and then the hull labels.
+     */
+    struct StateHeader {
+        char magic[8];
+        uint32_t width, height, depth;
+        uint32_t kx, ky, kz, kt;
+        uint32_t special, threshold, t;
+        uint32_t offsetX, offsetY, offsetZ, scale;
+        uint32_t lowPrecision, engine;
+        uint32_t first, last;  // The time steps [first, last) the labels cover
+        uint64_t reserved;
+    };
+
+    class State {
+    private:
+        Parameters *params;
+        void printError(const char *error);
+
+    public:
+        State(Parameters *params);
+        int t, first, last;
+        std::vector<unsigned char> border;
+        std::vector<float> labels;
+        void read(std::string filename);
+        void write(std::string filename);
+    };
+}
+
+#endif
@@ -0,0 +1,68 @@
+/**
+ * @file Stream.cpp
+ * @author Antonin Thioux (antonin.thioux@gmail.com)
+ * @brief This file contains the logic for receiving raw frames from stdin or a local Unix socket.
+ * @date last modified at 2026-10-16
+ * @version 1.0
+ */
+
+#include "Stream.h"
+
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace HullComputation;
+using namespace std;
+
+/**
+ * @brief Construct a new Stream object, connects to the source.
+ * @param source Either - for stdin or the path to a Unix socket.
+ */
+Stream::Stream(string source){
+    if (source == "-") {
+        fd = STDIN_FILENO;
+        return;
+    }
+
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (source.size() >= sizeof(address.sun_path)) {
+        cerr << "socket: " << source << " path is too long!" << endl;
+        exit(EXIT_FAILURE);
+    }
+    strcpy(address.sun_path, source.c_str());
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr *) &address, sizeof(address)) < 0) {
+        cerr << "socket: " << source << " could not be connected to!" << endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * @brief Destroy the Stream object, closes the socket.
+ */
+Stream::~Stream(){
+    if (fd != STDIN_FILENO) close(fd);
+}
+
+/**
+ * @brief This function blocks until a whole frame has arrived.
+ * @param destination Where to read the frame to.
+ * @param n The number of bytes in a frame.
+ * @return true If the frame was read, false if the stream ended (a trailing partial frame is dropped).
+ */
+bool Stream::read(unsigned char *destination, size_t n){
+    while (n > 0) {
+        ssize_t count = ::read(fd, destination, n);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) return false;
+        destination += count;
+        n -= count;
+    }
+    return true;
+}
@@ -0,0 +1,29 @@
+/**
+ * @file Stream.h
+ * @author Antonin Thioux (antonin.thioux@gmail.com)
+ * @brief Header file of Stream.cpp
+ * @date last modified at 2026-10-16
+ * @version 1.0
+ */
+
+#ifndef BP_STREAM_H
+#define BP_STREAM_H
+
+#include <iostream>
+#include <string>
+
+namespace HullComputation {
+    class Stream {
+    private:
+        int fd;
+
+    public:
+        Stream(std::string source);
+        ~Stream();
+        Stream(const Stream &) = delete;
+        Stream &operator=(const Stream &) = delete;
+        bool read(unsigned char *destination, size_t n);
+    };
+}
+
+#endif
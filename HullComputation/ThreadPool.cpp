@@ -0,0 +1,141 @@
+/**
+ * @file ThreadPool.cpp
+ * @author Antonin Thioux (antonin.thioux@gmail.com)
+ * @brief This file contains the logic for a fixed size pool of worker threads.
+ * @date last modified at 2026-10-16
+ * @version 1.0
+ */
+
+#include "ThreadPool.h"
+
+using namespace HullComputation;
+using namespace std;
+
+thread_local ThreadPool *ThreadPool::owner = nullptr;
+thread_local int ThreadPool::current = -1;
+
+/**
+ * @brief This function takes a task, from the back of the worker's own queue or else from the front of another's.
+ * Tasks submitted by a task go to the back of its worker's queue, so a worker runs the newest work it created
+ * while thieves take the oldest, which is usually the largest.
+ * @param self The index of the worker.
+ * @param task Where to move the task to.
+ * @return true If a task was taken.
+ */
+bool ThreadPool::take(int self, function<void()> &task){
+    int n = queues.size();
+    for (int i = 0; i < n; i++) {
+        Queue &queue = *queues[(self + i) % n];
+        lock_guard<mutex> guard(queue.lock);
+        if (queue.tasks.empty()) continue;
+        if (i == 0) {
+            task = move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief This function is run by each worker, it runs tasks until the pool is stopped.
+ * @param self The index of the worker.
+ */
+void ThreadPool::work(int self){
+    owner = this;
+    current = self;
+
+    while (true) {
+        function<void()> task;
+        if (!take(self, task)) {
+            unique_lock<mutex> guard(lock);
+            available.wait(guard, [this]{ return stopping || queued > 0; });
+            if (stopping && queued <= 0) return;
+            continue;
+        }
+
+        {
+            unique_lock<mutex> guard(lock);
+            queued--;
+        }
+
+        task();
+
+        unique_lock<mutex> guard(lock);
+        if (--pending == 0) finished.notify_all();
+    }
+}
+
+/**
+ * @brief Construct a new ThreadPool object.
+ * @param threads The number of workers, 0 uses one per hardware thread.
+ */
+ThreadPool::ThreadPool(int threads):pending(0),queued(0),stopping(0),turn(0){
+    if (threads <= 0) threads = max(1u, thread::hardware_concurrency());
+    for (int i = 0; i < threads; i++)
+        queues.emplace_back(new Queue());
+    for (int i = 0; i < threads; i++)
+        workers.emplace_back(&ThreadPool::work, this, i);
+}
+
+/**
+ * @brief Destroy the ThreadPool object, finishes the queued tasks first.
+ */
+ThreadPool::~ThreadPool(){
+    {
+        unique_lock<mutex> guard(lock);
+        stopping = 1;
+    }
+    available.notify_all();
+    for (thread &worker : workers)
+        worker.join();
+}
+
+/**
+ * @brief Getter for the number of workers.
+ * @return int The number of workers.
+ */
+int ThreadPool::size(){
+    return workers.size();
+}
+
+/**
+ * @brief Getter for the index of the worker running the calling thread, so tasks can keep state per worker.
+ * @return int The index of the worker, or -1 when called from outside the pool.
+ */
+int ThreadPool::worker(){
+    return (owner == this) ? current : -1;
+}
+
+/**
+ * @brief This function queues a task, on the calling worker's own queue or else spread over the workers in turn.
+ * @param task The task to run.
+ */
+void ThreadPool::submit(function<void()> task){
+    int self = worker();
+    {
+        unique_lock<mutex> guard(lock);
+        if (self == -1) self = turn++ % queues.size();
+        pending++;
+    }
+    {
+        lock_guard<mutex> guard(queues[self]->lock);
+        queues[self]->tasks.push_back(move(task));
+    }
+    {
+        unique_lock<mutex> guard(lock);
+        queued++;
+    }
+    available.notify_one();
+}
+
+/**
+ * @brief This function blocks until all submitted tasks are done.
+ */
+void ThreadPool::wait(){
+    unique_lock<mutex> guard(lock);
+    finished.wait(guard, [this]{ return pending == 0; });
+}
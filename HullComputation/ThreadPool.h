@@ -0,0 +1,51 @@
+/**
+ * @file ThreadPool.h
+ * @author Antonin Thioux (antonin.thioux@gmail.com)
+ * @brief Header file of ThreadPool.cpp
+ * @date last modified at 2026-10-16
+ * @version 1.0
+ */
+
+#ifndef BP_THREADPOOL_H
+#define BP_THREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace HullComputation {
+    class ThreadPool {
+    private:
+        /**
+         * @brief The tasks of a single worker, it takes them from the back while idle workers steal from the front.
+         */
+        struct Queue {
+            std::mutex lock;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        std::vector<std::thread> workers;
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::mutex lock;
+        std::condition_variable available, finished;
+        int pending, queued, stopping, turn;
+        static thread_local ThreadPool *owner;
+        static thread_local int current;
+        bool take(int self, std::function<void()> &task);
+        void work(int self);
+
+    public:
+        ThreadPool(int threads = 0);
+        ~ThreadPool();
+        int size();
+        int worker();
+        void submit(std::function<void()> task);
+        void wait();
+    };
+}
+
+#endif
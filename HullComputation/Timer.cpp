@@ -30,13 +30,23 @@ string Timer::formatTime(int ms) {
     return string(ss.str());
 }
 
+/**
+ * @brief This function waits for the device to finish its queued work, so that its time is counted.
+ * The native engine computes synchronously, so builds without ArrayFire have nothing to wait for.
+ */
+void Timer::sync(){
+#ifdef BP_ARRAYFIRE
+    af::sync();
+#endif
+}
+
 /**
  * @brief This function starts the timer for a task.
  * @param task The name of the task that should be used.
  * @param laps The number of subtasks to expect.
  */
 void Timer::start(const char *task, int laps){
-    af::sync();
+    sync();
     this->task = task;
     this->startTime = chrono::steady_clock::now();
 
@@ -46,6 +56,8 @@ void Timer::start(const char *task, int laps){
 
     if (laps == 1)
         cout << task << "..." << flush;
+    else if (laps == 0)  // Streams have an unknown number of batches
+        cout << task << " with streamed batches" << endl;
     else 
         cout << task << " with " << laps << " batches" << endl;
 }
@@ -57,7 +69,7 @@ void Timer::lap() {
     if (this->totalLaps == 1)
         return ;
     
-    af::sync();
+    sync();
     chrono::steady_clock::time_point endTime = chrono::steady_clock::now();
     string time = formatTime(chrono::duration_cast<chrono::microseconds>(endTime - this->lapTime).count());
     this->lapTime = endTime;
@@ -65,11 +77,33 @@ void Timer::lap() {
     cout << "\t[" << this->currentLap++ << "/" << this->totalLaps << "]\t\tcomplete, time = " << time << endl;
 }
 
+/**
+ * @brief This function starts timing the next lap, and reports how much of the IO was hidden behind computation.
+ * @param loadTime The microseconds spent loading the data of the lap.
+ * @param waitTime The microseconds the computation had to wait for that data.
+ */
+void Timer::lap(long loadTime, long waitTime) {
+    if (this->totalLaps == 1)
+        return ;
+
+    sync();
+    chrono::steady_clock::time_point endTime = chrono::steady_clock::now();
+    string time = formatTime(chrono::duration_cast<chrono::microseconds>(endTime - this->lapTime).count());
+    this->lapTime = endTime;
+    int overlap = (loadTime > 0) ? 100 * (loadTime - min(loadTime, waitTime)) / loadTime : 100;
+
+    cout << "\t[" << this->currentLap++ << "/";
+    if (this->totalLaps) cout << this->totalLaps;
+    else cout << "?";
+    cout << "]\t\tcomplete, time = " << time;
+    cout << ", io = " << formatTime(loadTime) << ", io wait = " << formatTime(waitTime) << " (" << overlap << "% overlap)" << endl;
+}
+
 /**
  * @brief This function stops timing the task.
  */
 void Timer::stop(){
-    af::sync();
+    sync();
     chrono::steady_clock::time_point endTime = chrono::steady_clock::now();
     string time = formatTime(chrono::duration_cast<chrono::microseconds>(endTime - this->startTime).count());
 
@@ -78,3 +112,14 @@ void Timer::stop(){
     else 
         cout << this->task << " is done! Total time = " << time << endl;
 }
+
+/**
+ * @brief This function reports the frame cache counters.
+ * @param hits The number of frames read from the cache.
+ * @param misses The number of frames read from disk.
+ */
+void Timer::cache(long hits, long misses){
+    long total = hits + misses;
+    cout << "Frame cache: " << hits << " hits, " << misses << " misses";
+    cout << " (" << ((total > 0) ? 100 * hits / total : 0) << "% hit rate)" << endl;
+}
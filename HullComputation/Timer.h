@@ -11,7 +11,9 @@
 
 #include <fstream>
 #include <iostream>
+#ifdef BP_ARRAYFIRE
 #include <arrayfire.h>
+#endif
 #include <sstream>
 #include <iomanip>
 #include <chrono>
@@ -23,11 +25,14 @@ namespace HullComputation {
         std::chrono::steady_clock::time_point startTime, lapTime;
         int currentLap, totalLaps;
         std::string formatTime(int ms);
+        void sync();
 
     public:
         void start(const char *task, int laps);
         void lap();
+        void lap(long loadTime, long waitTime);
         void stop();
+        void cache(long hits, long misses);
     };
 }
 
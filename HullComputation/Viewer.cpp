@@ -41,7 +41,6 @@ void Viewer::show(array hulls, array animation){
         array slice = flip(reorder(hulls(params->viewSlice, span, span), 1, 2, 0), 0);
         display(seq(bh - !(params->ky % 2), -1 - bh), seq(bw - !(params->kx % 2), -1 - bw - params->width)) = slice;
     } else {
-        array dest = display(seq(bh - !(params->ky % 2), -1 - bh), seq(bw - !(params->kx % 2), -1 - bw - params->width));
         display(seq(bh - !(params->ky % 2), -1 - bh), seq(bw - !(params->kx % 2), -1 - bw - params->width)) = flip(hulls, 0);
     }
 
@@ -8,13 +8,18 @@
 
 #include "Writer.h"
 
+#include <algorithm>
+#include <cmath>
+
 #define INTIAL_SIZE 300
 #define EPSILON 0.001
 #define COLORLESS 0.38431372549
 
 using namespace HullComputation;
-using namespace af;
-using namespace std;
+using std::string;
+using std::ostringstream;
+using std::ofstream;
+using std::endl;
 
 /**
  * @brief This helper function resizes the different vertex arrays.
@@ -172,10 +177,10 @@ void Writer::cubeCase(int ***vmap, int ***cases, float ***vals, int x, int y, in
 
         // iterate over all vetecies of triangle
         for (int j = 0; j < 3; j++) {
-            int v;
-            int vx = MarchingCubes::coords[faces[i + j]][0] + 2 * x;
-            int vy = MarchingCubes::coords[faces[i + j]][1] + 2 * y;
-            int vz = MarchingCubes::coords[faces[i + j]][2] + 2 * z;
+            int v, edge = faces[i + j];
+            int vx = MarchingCubes::coords[edge][0] + 2 * x;
+            int vy = MarchingCubes::coords[edge][1] + 2 * y;
+            int vz = MarchingCubes::coords[edge][2] + 2 * z;
         
             // new vertex?
             if (!(v = vmap[vx][vy][vz])) {
@@ -213,39 +218,47 @@ void Writer::cubeCase(int ***vmap, int ***cases, float ***vals, int x, int y, in
 
 /**
  * @brief The marching cubes algorithm.
- * @param M arrayfire matrix of data to use in marching cubes.
+ * @param M The volume to use in marching cubes, laid out with z varying fastest.
+ * @param width The width of the volume.
+ * @param height The height of the volume.
+ * @param depth The depth of the volume.
  * @param isColored Whether or not to color the vertexes based on values.
  */
-void Writer::marchingCubes(array M, int isColored) {
-    int width = M.dims(2), height = M.dims(1), depth = M.dims(0);
+void Writer::marchingCubes(const float *M, int width, int height, int depth, int isColored) {
     int ***vmap = createVertexMap(width, height, depth);
+    auto at = [&](int z, int y, int x) { return M[z + (long) depth * (y + (long) height * x)]; };
+    auto inside = [&](int z, int y, int x) { return (int) (at(z, y, x) > EPSILON); };
 
     // build case matrix
-    array B = (M > EPSILON), C;
-    C = 128*B(seq(1,-1),seq(1,-1),seq(0,-2)) + 64*B(seq(1,-1),seq(1,-1),seq(1,-1));
-    C += 32*B(seq(0,-2),seq(1,-1),seq(1,-1)) + 16*B(seq(0,-2),seq(1,-1),seq(0,-2));
-    C +=  8*B(seq(1,-1),seq(0,-2),seq(0,-2)) +  4*B(seq(1,-1),seq(0,-2),seq(1,-1));
-    C +=  2*B(seq(0,-2),seq(0,-2),seq(1,-1)) +  1*B(seq(0,-2),seq(0,-2),seq(0,-2));
     int ***cases = new int**[width - 1];
     for (int i = 0; i < width - 1; i++) {
         cases[i] = new int*[height - 1];
         for (int j = 0; j < height - 1; j++) {
             cases[i][j] = new int[depth - 1];
-            C(span, j, i).host(cases[i][j]);
+            for (int k = 0; k < depth - 1; k++) {
+                int c = 128 * inside(k + 1, j + 1, i) + 64 * inside(k + 1, j + 1, i + 1);
+                c += 32 * inside(k, j + 1, i + 1) + 16 * inside(k, j + 1, i);
+                c +=  8 * inside(k + 1, j, i) +  4 * inside(k + 1, j, i + 1);
+                c +=  2 * inside(k, j, i + 1) +  1 * inside(k, j, i);
+                cases[i][j][k] = c;
+            }
         }    
     }
 
-    array V = constant(0, depth * 2 - 1, height * 2 - 1, width * 2 - 1);
-    V(seq(0,-1,2),seq(0,-1,2),seq(0,-1,2)) = M;
-    V(seq(1,-2,2),seq(0,-1,2),seq(0,-1,2)) = af::max(M(seq(0,-2),span,span), M(seq(1,-1),span,span)); 
-    V(seq(0,-1,2),seq(1,-2,2),seq(0,-1,2)) = af::max(M(span,seq(0,-2),span), M(span,seq(1,-1),span)); 
-    V(seq(0,-1,2),seq(0,-1,2),seq(1,-2,2)) = af::max(M(span,span,seq(0,-2)), M(span,span,seq(1,-1))); 
+    // Vertexes on the grid take its value, those halfway along an edge the max of its ends
     float ***vals = new float**[width * 2 - 1];
     for (int i = 0; i < width * 2 - 1; i++){
         vals[i] = new float*[height * 2 - 1];
         for (int j = 0; j < height * 2 - 1; j++) {
             vals[i][j] = new float[depth * 2 - 1];
-            V(span, j, i).host(vals[i][j]);
+            for (int k = 0; k < depth * 2 - 1; k++) {
+                int x = i / 2, y = j / 2, z = k / 2;
+                if (i % 2 + j % 2 + k % 2 > 1) vals[i][j][k] = 0;
+                else if (i % 2) vals[i][j][k] = std::max(at(z, y, x), at(z, y, x + 1));
+                else if (j % 2) vals[i][j][k] = std::max(at(z, y, x), at(z, y + 1, x));
+                else if (k % 2) vals[i][j][k] = std::max(at(z, y, x), at(z + 1, y, x));
+                else vals[i][j][k] = at(z, y, x);
+            }
         }    
     }
 
@@ -295,9 +308,9 @@ void Writer::squareCase(int ***vmap, int **cases, float **vals, int x, int y, in
         
         // iterate over vetecies of triangle
         for (int j = 0; j < 3; j++) {
-            int v;
-            int vx = MarchingSquares::coords[faces[i + j]][0] + 2 * x;
-            int vy = MarchingSquares::coords[faces[i + j]][1] + 2 * y;
+            int v, edge = faces[i + j];
+            int vx = MarchingSquares::coords[edge][0] + 2 * x;
+            int vy = MarchingSquares::coords[edge][1] + 2 * y;
 
             // new vertex?
             if (!(v = vmap[vx][vy][0])) {
@@ -330,31 +343,35 @@ void Writer::squareCase(int ***vmap, int **cases, float **vals, int x, int y, in
 
 /**
  * @brief The marching square algorithm.
- * @param M arrayfire matrix of data to use in marching squares.
+ * @param M The image to use in marching squares, laid out with y varying fastest.
+ * @param width The width of the image.
+ * @param height The height of the image.
  * @param isColored Whether or not to color the vertexes based on values.
  */
-void Writer::marchingSquares(array M, int isColored) {
-    int width = M.dims(1), height = M.dims(0);
+void Writer::marchingSquares(const float *M, int width, int height, int isColored) {
     int ***vmap = createVertexMap(width, height);    
+    auto at = [&](int y, int x) { return M[y + (long) height * x]; };
+    auto inside = [&](int y, int x) { return (int) (at(y, x) > EPSILON); };
 
     // build case matrix
-    array B = (M > EPSILON), C;
-    C  = 8*B(seq(0,-2), seq(0,-2)) + 4*B(seq(1,-1), seq(0,-2));
-    C += 1*B(seq(0,-2), seq(1,-1)) + 2*B(seq(1,-1), seq(1,-1));
     int **cases = new int*[width - 1];
     for (int i = 0; i < width - 1; i++) {
         cases[i] = new int[height - 1];
-        C(span, i).host(cases[i]);
+        for (int j = 0; j < height - 1; j++)
+            cases[i][j] = 8 * inside(j, i) + 4 * inside(j + 1, i) + 1 * inside(j, i + 1) + 2 * inside(j + 1, i + 1);
     }
 
-    array V = constant(0, height * 2 - 1, width * 2 - 1);
-    V(seq(0 , -1, 2), seq(0, -1, 2)) = M;
-    V(seq(1, -2, 2), seq(0, -1, 2)) = af::max(M(seq(0,-2), span), M(seq(1,-1), span)); 
-    V(seq(0, -1, 2), seq(1, -2, 2)) = af::max(M(span, seq(0,-2)), M(span, seq(1,-1))); 
+    // Vertexes on the grid take its value, those halfway along an edge the max of its ends
     float **vals = new float*[width * 2 - 1];
     for (int i = 0; i < width * 2 - 1; i++){
         vals[i] = new float[height * 2 - 1];
-        V(span, i).host(vals[i]);
+        for (int j = 0; j < height * 2 - 1; j++) {
+            int x = i / 2, y = j / 2;
+            if (i % 2 && j % 2) vals[i][j] = 0;
+            else if (i % 2) vals[i][j] = std::max(at(y, x), at(y, x + 1));
+            else if (j % 2) vals[i][j] = std::max(at(y, x), at(y + 1, x));
+            else vals[i][j] = at(y, x);
+        }
     }
 
     // start marching
@@ -380,15 +397,18 @@ void Writer::marchingSquares(array M, int isColored) {
  */
 void Writer::extractAnimation(){
     Reader reader(params);
+    long frameSize = (long) params->depth * params->height * params->width;
+    std::vector<unsigned char> frame(frameSize);
+    std::vector<float> M(frameSize);
+
     for (int i = 0; i < params->duration; i++) {
-        array M = reader.readFile(params->datafiles[i]);
-        M(M < 0xE0) = 0;
-        vertexCount = 0;
-        faceCount = 0;
+        reader.getFrame(i, frame.data());
+        for (long v = 0; v < frameSize; v++) M[v] = (frame[v] < 0xE0) ? 0 : frame[v];
+        reset();
         if (params->is4D) 
-            marchingCubes(reorder(M, 1, 2, 3, 0), 0);
+            marchingCubes(M.data(), params->width, params->height, params->depth, 0);
         else 
-            marchingSquares(reorder(M, 2, 3, 0, 1), 0);
+            marchingSquares(M.data(), params->width, params->height, 0);
         ostringstream ss;
         ss << "animation_" << i << ".obj";
         output(ss.str());
@@ -396,21 +416,78 @@ void Writer::extractAnimation(){
 }
 
 /**
- * @brief This function starts the extraction of the hulls in the pipeline.
- * @param hulls Arrayfire matrix of hulls to extract.
+ * @brief This helper function clears the mesh of a previous extraction, normals are accumulated so they need zeroing.
  */
-void Writer::extract(array hulls){
-    if (params->exportAnimation)
-        extractAnimation();
-    
+void Writer::reset() {
     vertexCount = 0;
     faceCount = 0;
+    for (int i = 0; i < vertexSize; i++)
+        coords[i] = colors[i] = normals[i] = 0;
+}
+
+/**
+ * @brief This helper function gives the number of voxels in the hulls of a single threshold.
+ * @return long The size of the hulls.
+ */
+long Writer::hullSize(){
+    return (long) (params->width - params->kx + 1) * (params->height - params->ky + 1) * ((params->is4D) ? params->depth - params->kz + 1 : 1);
+}
+
+/**
+ * @brief This function extracts hulls into an object file.
+ * @param hulls The hulls to extract, laid out with z varying fastest.
+ * @param filename The object file to write.
+ */
+void Writer::extractHulls(const float *hulls, string filename){
+    int width = params->width - params->kx + 1, height = params->height - params->ky + 1;
+    reset();
     if (params->is4D) 
-        marchingCubes(hulls, 1);
+        marchingCubes(hulls, width, height, params->depth - params->kz + 1, 1);
     else 
-        marchingSquares(hulls, 1);
+        marchingSquares(hulls, width, height, 1);
     
-    output("hulls.obj");
+    output(filename);
+}
+
+/**
+ * @brief This function starts the extraction of the hulls in the pipeline.
+ * The hulls of the first threshold are written to hulls.obj, a threshold sweep also writes every threshold's hulls to hulls_th<N>.obj.
+ * @param hulls The hulls to extract, the hulls of each threshold one after the other.
+ */
+void Writer::extract(const float *hulls){
+    if (params->exportAnimation)
+        extractAnimation();
+
+    extractHulls(hulls, "hulls.obj");
+    if (params->thresholds.size() == 1) return;
+
+    for (size_t i = 0; i < params->thresholds.size(); i++) {
+        ostringstream ss;
+        ss << "hulls_th" << params->thresholds[i] << ".obj";
+        extractHulls(hulls + i * hullSize(), ss.str());
+    }
+}
+
+/**
+ * @brief This function extracts the hulls computed so far while frames are still coming in, for the first threshold only.
+ * @param hulls The hulls to extract.
+ * @param frames The number of frames the hulls were computed from.
+ */
+void Writer::snapshot(const float *hulls, int frames){
+    ostringstream ss;
+    ss << "hulls_snapshot_" << frames << ".obj";
+    extractHulls(hulls, ss.str());
+}
+
+/**
+ * @brief This function extracts the hulls of a coarse pyramid level, for the first threshold only.
+ * @param hulls The hulls to extract.
+ * @param level The level of the pyramid the hulls were computed at.
+ */
+void Writer::preview(const float *hulls, int level){
+    ostringstream ss;
+    ss << "hulls_L" << level << ".obj";
+    extractHulls(hulls, ss.str());
 }
 
 /**
@@ -418,7 +495,7 @@ void Writer::extract(array hulls){
  * @param params The parameters object.
  */
 Writer::Writer(Parameters *params)
-:params(params),meshSize(INTIAL_SIZE),vertexSize(INTIAL_SIZE) {
+:params(params),vertexSize(INTIAL_SIZE),meshSize(INTIAL_SIZE) {
     mesh = new int[meshSize];
     for (int i = 0; i < meshSize; i++) 
         mesh[i] = 0;
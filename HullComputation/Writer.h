@@ -9,10 +9,10 @@
 #ifndef BP_WRITER_H
 #define BP_WRITER_H
 
-#include <arrayfire.h>
 #include <sstream>
 #include <iostream>
 #include <fstream>
+#include <vector>
 
 #include "Parameters.h"
 #include "Reader.h"
@@ -30,6 +30,7 @@ namespace HullComputation{
         // Helper functions
         void resizeVertexes();
         void resizeMesh();
+        void reset();
         void normalizeNormals();
         void scaleCoords(int width, int height, int depth = 1);
         int ***createVertexMap(int width, int height, int depth = 1);
@@ -38,15 +39,19 @@ namespace HullComputation{
         // primary functions
         void extractAnimation();
         void squareCase(int ***vmap, int **cases, float **vals, int x, int y, int isColored);
-        void marchingSquares(af::array M, int isColored);
+        void marchingSquares(const float *M, int width, int height, int isColored);
         void cubeCase(int ***vmap, int ***cases, float ***vals, int x, int y, int z, int isColored);
-        void marchingCubes(af::array M, int isColored);
+        void marchingCubes(const float *M, int width, int height, int depth, int isColored);
+        long hullSize();
+        void extractHulls(const float *hulls, std::string filename);
         void output(std::string filename);
 
     public:
         Writer(Parameters *params);
         ~Writer();
-        void extract(af::array hulls);
+        void extract(const float *hulls);
+        void snapshot(const float *hulls, int frames);
+        void preview(const float *hulls, int level);
     };
 }
 
@@ -7,47 +7,189 @@
  */
 
 #include <iostream>
+#include <cstring>
+#include <vector>
+#ifdef BP_ARRAYFIRE
 #include <arrayfire.h>
+#include "Viewer.h"
+#endif
 
 #include "Parameters.h"
 #include "Timer.h"
 #include "Reader.h"
-#include "Viewer.h"
-#include "Calc.h"
+#include "Engine.h"
 #include "Writer.h"
+#include "FrameCache.h"
+#include "State.h"
 
 using namespace std;
 using namespace HullComputation;
 
 void debugWriter(Parameters *params);
 
+/**
+ * @brief This function shrinks the window when the device used more memory than the budget allows.
+ * The memory manager keeps freed buffers around, so the allocated bytes are the peak of the last batch.
+ * The reader hands out the next window at the new length, even though its frames are already being prefetched.
+ * The native engine works on tiles of the window on the host, so it is sized by the budget upfront only.
+ * @param params Parameters object.
+ * @param reader The reader providing the windows.
+ */
+void fitBudget(Parameters *params, Reader &reader) {
+#ifdef BP_ARRAYFIRE
+    if (params->engine != ENGINE_ARRAYFIRE) return;
+    size_t allocBytes, allocBuffers, lockBytes, lockBuffers;
+    af::deviceMemInfo(&allocBytes, &allocBuffers, &lockBytes, &lockBuffers);
+
+    size_t budget = (size_t) params->memoryBudget << 20;
+    if (allocBytes <= budget) return;
+    reader.setWindow((int) (reader.getWindow() * ((double) budget / allocBytes)));
+    af::deviceGC();  // Release the buffers of the larger window so the next peak is measured on its own
+#else
+    (void) params;
+    (void) reader;
+#endif
+}
+
+/**
+ * @brief This function computes the hulls of the selected region, a window at a time, resuming and saving its state if asked.
+ * @param params Parameters object.
+ * @param timer The timer of the computation.
+ * @param writer The writer for snapshots.
+ * @return std::vector<float> The hulls of the region.
+ */
+std::vector<float> compute(Parameters *params, Timer &timer, Writer &writer) {
+    Reader reader(params);
+    Engine *engine = Engine::create(params);
+
+    // A resumed run continues from the labels of the state, its border frames come before the new frames
+    int first = params->firstStep;
+    if (!params->resume.empty()) {
+        State state(params);
+        state.read(params->resume);
+        first = state.first;
+        engine->resume(state.labels.data(), state.t);
+        reader.preload(state.border.data(), params->kt - 1);
+    }
+
+    int frames = 0, snapshot = 0;
+    const unsigned char *window;
+    while (reader.hasNextBatch()) {
+        int length = reader.getNextBatch(window);
+        engine->process(window, length);
+        if (params->isTimed) timer.lap(reader.getLoadTime(), reader.getWaitTime());
+        if (params->memoryBudget) fitBudget(params, reader);
+
+        // Write the hulls so far once enough new frames came in
+        frames += length - ((frames) ? params->kt - 1 : 0);
+        if (params->snapshotEvery && frames - snapshot >= params->snapshotEvery) {
+            writer.snapshot(engine->getHulls().data(), frames);
+            snapshot = frames;
+        }
+    }
+
+    if (!params->saveState.empty()) {
+        State state(params);
+        state.t = engine->getTime();
+        state.first = first;
+        memcpy(state.labels.data(), engine->getLabels(), state.labels.size() * sizeof(float));
+        reader.getBorder(state.border.data());
+        state.write(params->saveState);
+    }
+
+    std::vector<float> hulls = engine->getHulls();
+    delete engine;
+    return hulls;
+}
+
+/**
+ * @brief This function computes the hulls one brick at a time, so only a brick and its halo of every frame is in memory at once.
+ * Every brick covers the same frames, so their normalised hulls can be placed side by side.
+ * @param params Parameters object.
+ * @param timer The timer of the computation.
+ * @param writer The writer for snapshots.
+ * @return std::vector<float> The hulls of the whole region.
+ */
+std::vector<float> computeBricks(Parameters *params, Timer &timer, Writer &writer) {
+    int width = params->width - params->kx + 1, height = params->height - params->ky + 1;
+    int depth = (params->is4D) ? params->depth - params->kz + 1 : 1;
+    std::vector<float> hulls((long) width * height * depth, 0.0f);
+
+    for (int b = 0; b < params->bricks; b++) {
+        params->selectBrick(b);
+        FrameCache::shared().clear();  // Cached frames are keyed by index, which now refers to another brick
+        std::vector<float> brick = compute(params, timer, writer);
+
+        // Both are laid out with z varying fastest, so the brick is pasted a z column at a time
+        int bw = params->width - params->kx + 1, bh = params->height - params->ky + 1;
+        int bd = (params->is4D) ? params->depth - params->kz + 1 : 1;
+        for (int x = 0; x < bw; x++)
+            for (int y = 0; y < bh; y++)
+                memcpy(hulls.data() + params->brickZ + depth * (params->brickY + y + (long) height * (params->brickX + x)),
+                       brick.data() + bd * (y + (long) bh * x), bd * sizeof(float));
+    }
+
+    params->selectBrick(-1);
+    FrameCache::shared().clear();
+    return hulls;
+}
+
+/**
+ * @brief This function computes and extracts preview hulls from the coarsest level of the pyramid down,
+ * each level at twice the resolution of the previous one. The full resolution is selected again afterwards.
+ * @param params Parameters object.
+ * @param timer The timer of the computation.
+ * @param writer The writer for the previews.
+ */
+void computePyramid(Parameters *params, Timer &timer, Writer &writer) {
+    for (int level = params->pyramid; level > 0; level--) {
+        params->selectLevel(level);
+        FrameCache::shared().clear();  // Cached frames are keyed by index, which now refers to another resolution
+        if (params->isTimed) timer.start("Computing preview", params->batches);
+        std::vector<float> hulls = compute(params, timer, writer);
+        if (params->isTimed) timer.stop();
+        writer.preview(hulls.data(), level);
+    }
+
+    params->selectLevel(0);
+    FrameCache::shared().clear();
+}
+
 /**
  * @brief This function runs the hull computation and extraction pipeline.
  * @param params Parameters object.
  */
 void pipeline(Parameters *params) {
     Timer timer;
-    Reader reader(params);
-    Calc calc(params);
+    FrameCache::shared().setBudget((size_t) params->cacheSize << 20);
     Writer writer(params);
 
-    if (params->isTimed) timer.start("Computing", params->batches);
-    for (int _ = 0; _ < params->batches; _++) {
-        af::array batch = reader.getNextBatch();
-        calc.processBatch(batch);
-        if (params->isTimed) timer.lap();
-    }
-    af::array hulls = calc.getHulls();
+    if (params->pyramid) computePyramid(params, timer, writer);
+
+    if (params->isTimed) timer.start("Computing", params->batches * params->bricks);
+    std::vector<float> hulls = (params->bricks > 1) ? computeBricks(params, timer, writer) : compute(params, timer, writer);
     if (params->isTimed) timer.stop();
+    if (params->isSharded) return;  // The partial hulls were saved, they are extracted by merge
 
     if (params->isTimed) timer.start("Extracting", 1);
-    writer.extract(hulls);
+    writer.extract(hulls.data());
     if (params->isTimed) timer.stop();   
 
+#ifdef BP_ARRAYFIRE
+    af::array animation;
+    if (params->isViewed) animation = Reader(params).getAnimation();
+#endif
+    if (params->isTimed) timer.cache(FrameCache::shared().getHits(), FrameCache::shared().getMisses());
+
+#ifdef BP_ARRAYFIRE
     if (params->isViewed){
+        // The viewer shows the hulls of the first threshold
+        int width = params->width - params->kx + 1, height = params->height - params->ky + 1;
+        af::array view = (params->is4D) ? af::array(params->depth - params->kz + 1, height, width, hulls.data()) : af::array(height, width, hulls.data());
         Viewer viewer(params);
-        viewer.show(hulls, reader.getAnimation());
+        viewer.show(view, animation);
     }
+#endif
 }
 
 /**
@@ -73,10 +215,10 @@ int main(int argc, char *argv[]) {
 void debugWriter(Parameters *params) {
     Writer writer(params);
 
-    af::array hulls = af::constant(0, 3, 3);
-    hulls(1, 1) = 0x62;
+    std::vector<float> hulls(9, 0.0f);
+    hulls[1 + 3 * 1] = 0x62;
 
-    writer.extract(hulls);
+    writer.extract(hulls.data());
 }
 
 /**
@@ -98,10 +240,10 @@ void debugParams(Parameters *params){
  */
 void testBatching(Parameters *params){
     Reader reader(params);
-    af::array batch;
-    for (int i = 0; i < params->batches; i++){
-        batch = reader.getNextBatch();
-        cout << "batch: " << i << ", size: " << batch.dims(0) << ", type: " << batch.type() << endl;
+    const unsigned char *batch;
+    for (int i = 0; reader.hasNextBatch(); i++){
+        int length = reader.getNextBatch(batch);
+        cout << "batch: " << i << ", size: " << length << ", type: u8" << endl;
     }
     cout << "finished tests" << endl;
 
@@ -0,0 +1,82 @@
+/**
+ * @file merge.cpp
+ * @author Antonin Thioux (antonin.thioux@gmail.com)
+ * @brief This file contains the merge program, which reduces the partial hulls of shards and extracts the result.
+ * @date last modified at 2026-10-16
+ * @version 1.0
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "Parameters.h"
+#include "State.h"
+#include "Engine.h"
+#include "Writer.h"
+
+using namespace std;
+using namespace HullComputation;
+
+/**
+ * This is the main function for the merge program.
+ * Usage: merge <DIMENSION-FILE> <PARTIAL>... [OPTIONS], the options are those the shards were computed with.
+ * @param argc The number of arguments.
+ * @param argv The array of arguments.
+ * @return Exit success when the merged hulls are extracted.
+ */
+int main(int argc, char *argv[]) {
+    // The partial files follow the dimension file, everything after them is passed on as options
+    vector<char *> arguments(argv, argv + min(argc, 2));
+    vector<string> partials;
+    int i = min(argc, 2);
+    for (; i < argc && argv[i][0] != '-'; i++) partials.push_back(argv[i]);
+    arguments.insert(arguments.end(), argv + i, argv + argc);
+
+    if (argc >= 2 && partials.empty() && strcmp(argv[1], "-h") && strcmp(argv[1], "--help")) {
+        cerr << "[Usage Error]: \tNo partial hulls given!" << endl;
+        cout << "merge <DIMENSION-FILE> <PARTIAL>... [OPTIONS], see compute -h for the options" << endl;
+        return EXIT_FAILURE;
+    }
+    Parameters params(arguments.size(), arguments.data());
+    if (params.isSharded) {
+        cerr << "[Usage Error]: \tMerged hulls cover the whole time series, do not give a time range!" << endl;
+        return EXIT_FAILURE;
+    }
+
+    // Labels are those of the whole time series, so the latest one over all shards is kept
+    State merged(&params);
+    vector<pair<int, int>> ranges;
+    for (const string &partial : partials) {
+        State state(&params);
+        state.read(partial);
+        for (size_t v = 0; v < merged.labels.size(); v++) merged.labels[v] = max(merged.labels[v], state.labels[v]);
+        merged.t = max(merged.t, state.t);
+        ranges.push_back(make_pair(state.first, state.last));
+    }
+
+    // The shards have to cover every time step once, a missing one would silently leave steps out of the hulls
+    sort(ranges.begin(), ranges.end());
+    int covered = 0;
+    for (const pair<int, int> &range : ranges) {
+        if (range.first > covered) {
+            cerr << "[Merge Error]: \tThe shards do not cover the time steps [" << covered << ", " << range.first << ")!" << endl;
+            return EXIT_FAILURE;
+        }
+        if (range.first < covered) {
+            cerr << "[Merge Error]: \tThe shards overlap at time step " << range.first << "!" << endl;
+            return EXIT_FAILURE;
+        }
+        covered = range.second;
+    }
+    int steps = params.duration - params.kt + 1;
+    if (covered != steps) {
+        cerr << "[Merge Error]: \tThe shards do not cover the time steps [" << covered << ", " << steps << ")!" << endl;
+        return EXIT_FAILURE;
+    }
+
+    Writer writer(&params);
+    writer.extract(Engine::normalise(merged.labels.data(), merged.labels.size(), merged.t).data());
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file golden.cpp
+ * @author Antonin Thioux (antonin.thioux@gmail.com)
+ * @brief This file contains the golden hull test, it computes the labels of a region with every engine that is built
+ * and checks them against the labels of the reference and against each other.
+ * @date last modified at 2026-10-16
+ * @version 1.0
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "../HullComputation/Parameters.h"
+#include "../HullComputation/Reader.h"
+#include "../HullComputation/Engine.h"
+
+// The engines scale and order their arithmetic differently from the reference, so voxels whose measure is within
+// rounding of a threshold can flip, at most this share of the voxels may disagree
+#define GOLDEN_TOLERANCE 0.002
+
+using namespace HullComputation;
+
+/**
+ * @brief This function computes the labels of the region a window at a time, like compute does.
+ * @param params The Parameters object.
+ * @param engine The engine to compute them with.
+ * @return std::vector<float> The labels.
+ */
+std::vector<float> computeLabels(Parameters *params, int engine) {
+    params->engine = engine;
+    Reader reader(params);
+    Engine *hulls = Engine::create(params);
+    const unsigned char *window;
+    while (reader.hasNextBatch()) {
+        int length = reader.getNextBatch(window);
+        hulls->process(window, length);
+    }
+    std::vector<float> labels(hulls->getLabels(), hulls->getLabels() + hulls->getSize());
+    delete hulls;
+    return labels;
+}
+
+/**
+ * @brief This function compares two sets of labels and prints how far apart they are.
+ * @param name What is compared.
+ * @param a The first labels.
+ * @param b The second labels.
+ * @return true If they agree within the tolerance.
+ */
+bool compare(const char *name, const std::vector<float> &a, const std::vector<float> &b) {
+    if (a.size() != b.size()) {
+        printf("%s: %zu labels against %zu\n", name, a.size(), b.size());
+        return false;
+    }
+    long differ = 0, hulls = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        differ += (a[i] != b[i]);
+        hulls += (a[i] > 0 || b[i] > 0);
+    }
+    printf("%s: %ld of %zu labels differ, %ld voxels in either hull\n", name, differ, a.size(), hulls);
+    return hulls > 0 && differ <= GOLDEN_TOLERANCE * a.size();
+}
+
+/**
+ * This is the main function of the golden test, it takes the labels of the reference followed by the options of compute.
+ * Without an engine option every engine that is built is tested, and they are also compared with each other.
+ * @param argc The number of arguments.
+ * @param argv The array of arguments.
+ * @return Exit success when every engine agrees with the reference.
+ */
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: golden <LABELS> <DIMENSION-FILE> [OPTIONS]\n");
+        return EXIT_FAILURE;
+    }
+    Parameters params(argc - 1, argv + 1);
+
+    std::vector<float> reference;
+    FILE *file = fopen(argv[1], "rb");
+    if (!file) {
+        fprintf(stderr, "could not open %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    float label;
+    while (fread(&label, sizeof(float), 1, file) == 1) reference.push_back(label);
+    fclose(file);
+
+    std::vector<int> engines = {ENGINE_NATIVE};
+#ifdef BP_ARRAYFIRE
+    engines.push_back(ENGINE_ARRAYFIRE);
+#endif
+    for (int i = 3; i < argc; i++)
+        if (std::string(argv[i]) == "-e" || std::string(argv[i]) == "--engine") engines = {params.engine};
+
+    bool passed = true;
+    std::vector<std::vector<float>> labels;
+    for (int engine : engines) {
+        labels.push_back(computeLabels(&params, engine));
+        std::string name = (engine == ENGINE_NATIVE) ? "native" : "af";
+        passed &= compare((name + " against the reference").c_str(), labels.back(), reference);
+    }
+    if (labels.size() == 2) passed &= compare("af against native", labels[1], labels[0]);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,158 @@
+/**
+ * @file reference.cpp
+ * @author Antonin Thioux (antonin.thioux@gmail.com)
+ * @brief This file contains the reference computation of the hull labels the engines are tested against.
+ * It is the original ArrayFire algorithm written out over plain arrays: a chain of two tap passes per kernel,
+ * time first, over the whole time series at once, so it shares no filtering code with the engines.
+ * @date last modified at 2026-10-16
+ * @version 1.0
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "../HullComputation/Parameters.h"
+#include "../HullComputation/Reader.h"
+
+using namespace HullComputation;
+
+/**
+ * @brief A 4D array of floats, laid out like the frames with z varying fastest and time last.
+ */
+struct Volume {
+    int n[4];  // z, y, x, t
+    std::vector<float> values;
+    long stride(int dim) const {
+        long s = 1;
+        for (int d = 0; d < dim; d++) s *= n[d];
+        return s;
+    }
+};
+
+/**
+ * @brief This function applies a two tap pass across a dimension, the sum of neighbours or their difference like Calc::guassian and Calc::derivative did.
+ * @param M The array.
+ * @param dim The dimension to pass across.
+ * @param isDerivative Whether the pass differences the neighbours.
+ * @return Volume The array, one shorter across the dimension.
+ */
+Volume pass(const Volume &M, int dim, int isDerivative) {
+    Volume R = M;
+    R.n[dim]--;
+    R.values.assign((long) R.n[0] * R.n[1] * R.n[2] * R.n[3], 0.0f);
+    long inner = M.stride(dim), outer = (long) R.n[0] * R.n[1] * R.n[2] * R.n[3] / (inner * R.n[dim]);
+    for (long o = 0; o < outer; o++)
+        for (int i = 0; i < R.n[dim]; i++)
+            for (long j = 0; j < inner; j++) {
+                float a = M.values[j + inner * (i + (long) M.n[dim] * o)], b = M.values[j + inner * (i + 1 + (long) M.n[dim] * o)];
+                R.values[j + inner * (i + (long) R.n[dim] * o)] = isDerivative ? a - b : a + b;
+            }
+    return R;
+}
+
+/**
+ * @brief This function applies a sobel-like operator, in the original order: time, z, y and then x.
+ * Calc::sobelD2 differenced the first pass across dev[0] and the second pass across dev[1],
+ * Calc::sobelD3 differenced the first passes across a dimension as often as it is in dev.
+ * @param M The frames as floats in [0, 1].
+ * @param sizes The kernel size per dimension, in the original numbering (t, z, y, x).
+ * @param dev The dimensions differenced, -1 for none, in the original numbering.
+ * @param isThird Whether this is a third derivative, like Calc::sobelD3.
+ * @return Volume The filtered array.
+ */
+Volume sobel(Volume M, const int sizes[4], const int dev[3], int isThird) {
+    const int dimension[4] = {3, 0, 1, 2};  // The original numbering in the layout of the volume
+    for (int d = 0; d < 4; d++) {
+        int count = (dev[0] == d) + (dev[1] == d) + (dev[2] == d);
+        for (int i = 0; i < sizes[d] - 1; i++) {
+            int isDerivative = isThird ? (i < count) : ((i == 0 && dev[0] == d) || (i == 1 && dev[1] == d));
+            M = pass(M, dimension[d], isDerivative);
+        }
+    }
+    return M;
+}
+
+/**
+ * @brief This function adds the weighted square of a sobel-like operator to the spacetime measure.
+ * @param spacetime The spacetime measure, empty before the first term.
+ * @param term The sobel-like operator applied to the frames.
+ * @param weight The weight of the term.
+ */
+void addTerm(Volume &spacetime, const Volume &term, float weight) {
+    if (spacetime.values.empty()) {
+        spacetime = term;
+        for (float &v : spacetime.values) v = v * v;
+    } else
+        for (size_t i = 0; i < term.values.size(); i++) spacetime.values[i] += weight * (term.values[i] * term.values[i]);
+}
+
+/**
+ * This is the main function of the reference, it takes the file to write the labels to followed by the options of compute.
+ * The labels are written as raw floats laid out like Engine::getLabels gives them, the labels of a sweep one after the other.
+ * @param argc The number of arguments.
+ * @param argv The array of arguments.
+ * @return Exit success when the labels are written.
+ */
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: reference <LABELS> <DIMENSION-FILE> [OPTIONS]\n");
+        return EXIT_FAILURE;
+    }
+    Parameters params(argc - 1, argv + 1);
+    Reader reader(&params);
+
+    Volume batch = {{params.depth, params.height, params.width, params.duration}, {}};
+    long frameSize = (long) params.depth * params.height * params.width;
+    std::vector<unsigned char> frame(frameSize);
+    batch.values.resize(frameSize * params.duration);
+    for (int f = 0; f < params.duration; f++) {
+        reader.getFrame(f, frame.data());
+        for (long v = 0; v < frameSize; v++) batch.values[v + frameSize * f] = frame[v] / 255.0f;
+    }
+
+    // Same terms as the original processBatch, 3D data has no z dimension
+    const int sizes[4] = {params.kt, params.is4D ? params.kz : 1, params.ky, params.kx};
+    Volume spacetime;
+    if (params.special == 0 || params.special == 1)
+        for (int d = 0; d < 4; d++) {
+            if (!params.is4D && d == 1) continue;
+            const int dev[3] = {d, d, -1};
+            addTerm(spacetime, sobel(batch, sizes, dev, 0), 1);
+        }
+    if (params.special == 0)
+        for (int d0 = 0; d0 < 4; d0++)
+            for (int d1 = d0 + 1; d1 < 4; d1++) {
+                if (!params.is4D && (d0 == 1 || d1 == 1)) continue;
+                const int dev[3] = {d0, d1, -1};
+                addTerm(spacetime, sobel(batch, sizes, dev, 0), 2);
+            }
+    if (params.special == 2)
+        for (int d = 3; d >= 1; d--) {
+            if (!params.is4D && d == 1) continue;
+            const int dev[3] = {0, 0, d};
+            addTerm(spacetime, sobel(batch, sizes, dev, 1), 1);
+        }
+
+    // Label every voxel with the latest time step above the threshold, counting from 1
+    long voxels = spacetime.stride(3);
+    std::vector<float> labels;
+    for (int threshold : params.thresholds) {
+        float cutoff = (float) threshold * threshold;
+        std::vector<float> hull(voxels, 0.0f);
+        for (int s = 0; s < spacetime.n[3]; s++)
+            for (long v = 0; v < voxels; v++) {
+                float value = spacetime.values[v + voxels * s];
+                if (value >= cutoff && value > 1) hull[v] = s + 1;
+            }
+        labels.insert(labels.end(), hull.begin(), hull.end());
+    }
+
+    FILE *file = fopen(argv[1], "wb");
+    if (!file || fwrite(labels.data(), sizeof(float), labels.size(), file) != labels.size()) {
+        fprintf(stderr, "could not write %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    fclose(file);
+    return EXIT_SUCCESS;
+}